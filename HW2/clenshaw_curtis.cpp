@@ -0,0 +1,222 @@
+//  file: clenshaw_curtis.cpp
+//
+//  Clenshaw-Curtis integration.  The integrand is sampled at the
+//   Chebyshev points x_j = cos(pi j/N), j = 0,...,N (mapped to [a,b]),
+//   its Chebyshev coefficients are found with a discrete cosine
+//   transform (done with an FFT), and the series is integrated term by
+//   term:  integral of T_k from -1 to 1 = 2/(1-k^2) for even k, else 0.
+//
+//  Revision history:
+//      17-Oct-2026  original version
+//
+//  Notes:
+//   * N is doubled until the last two integrals agree.  The points for
+//      N are every other point for 2N, so all earlier samples are kept.
+//   * The DCT-I of f_0,...,f_N is the FFT of the even extension
+//      f_0,...,f_N,f_{N-1},...,f_1 (length 2N, a power of 2).
+//   * For smooth integrands the coefficients fall off exponentially,
+//      so a few tens of points give double precision.
+//   * compile with:  "g++ -Wall -c clenshaw_curtis.cpp" or makefile
+//
+//************************************************************************
+
+// include files
+#include <cmath>
+#include <complex>
+#include <vector>
+using namespace std;
+
+#include "clenshaw_curtis.h"   // prototypes
+
+// local definitions and helper functions
+const int min_intervals = 8;        // first N
+const int max_intervals = 1 << 16;  // largest N
+
+static void fft (vector< complex<double> > &data);
+static void chebyshev_coefficients (const vector<double> &samples,
+                                    vector<double> &coeffs);
+static double series_integral (const vector<double> &coeffs);
+static double clenshaw_sum (const vector<double> &coeffs, double t);
+
+//************************************************************************
+
+// Integral of f from a to b by Clenshaw-Curtis on nested Chebyshev grids
+int cc_integrate (cc_integrand_t f, void *params, double a, double b,
+                  double abs_error, double rel_error, double *result_ptr,
+                  double *error_ptr, long *num_evals_ptr,
+                  chebyshev_series *series_ptr)
+{
+   const double pi = 3.14159265358979323846;
+   double center = 0.5 * (a + b);
+   double half_width = 0.5 * (b - a);
+
+   int num_intervals = min_intervals;
+   vector<double> samples (num_intervals + 1);  // f at x_j, j = 0,...,N
+   for (int j=0; j<=num_intervals; j++)
+   {
+     samples[j] = f (center + half_width * cos (pi*j/num_intervals), params);
+   }
+   long num_evals = num_intervals + 1;
+
+   vector<double> coeffs;
+   chebyshev_coefficients (samples, coeffs);
+   double result = half_width * series_integral (coeffs);
+   double error = fabs (result);
+   int status = 1;
+
+   while (num_intervals < max_intervals)
+   {
+     // double N: old points are the even ones, evaluate only the odd ones
+     vector<double> new_samples (2*num_intervals + 1);
+     for (int j=0; j<=num_intervals; j++)
+     {
+       new_samples[2*j] = samples[j];
+     }
+     num_intervals *= 2;
+     for (int j=1; j<num_intervals; j+=2)
+     {
+       new_samples[j] = f (center + half_width * cos (pi*j/num_intervals),
+                           params);
+     }
+     num_evals += num_intervals / 2;
+     samples.swap (new_samples);
+
+     chebyshev_coefficients (samples, coeffs);
+     double new_result = half_width * series_integral (coeffs);
+     error = fabs (new_result - result);
+     result = new_result;
+     if (error <= fmax (abs_error, rel_error * fabs (result)))
+     {
+       status = 0;
+       break;
+     }
+   }
+
+   *result_ptr = result;
+   *error_ptr = error;
+   *num_evals_ptr = num_evals;
+   if (series_ptr != NULL)
+   {
+     series_ptr->a = a;
+     series_ptr->b = b;
+     series_ptr->coeffs = coeffs;
+   }
+   return (status);
+}
+
+// Integral of the Chebyshev series from c to d, using the series for the
+//  antiderivative:  C_1 = c_0 - c_2/2,  C_k = (c_{k-1} - c_{k+1})/(2k)
+double chebyshev_integral (const chebyshev_series &series, double c, double d)
+{
+   const vector<double> &coeffs = series.coeffs;
+   int num = coeffs.size ();
+   vector<double> anti (num + 1, 0.);     // coefficients of antiderivative
+   for (int k=1; k<=num; k++)
+   {
+     double before = (k == 1) ? 2.*coeffs[0] : coeffs[k-1];
+     double after = (k+1 < num) ? coeffs[k+1] : 0.;
+     anti[k] = (before - after) / (2.*k);
+   }
+
+   double half_width = 0.5 * (series.b - series.a);
+   double center = 0.5 * (series.a + series.b);
+   double t_c = (c - center) / half_width;
+   double t_d = (d - center) / half_width;
+   return (half_width * (clenshaw_sum (anti, t_d) - clenshaw_sum (anti, t_c)));
+}
+
+// Value of the Chebyshev series at x
+double chebyshev_value (const chebyshev_series &series, double x)
+{
+   double t = (2.*x - series.a - series.b) / (series.b - series.a);
+   return (clenshaw_sum (series.coeffs, t));
+}
+
+//************************************************************************
+
+// Chebyshev coefficients c_0,...,c_N of the samples f_0,...,f_N, with
+//  f(t) = sum of c_k T_k(t) (the usual halved c_0 and c_N included)
+static void chebyshev_coefficients (const vector<double> &samples,
+                                    vector<double> &coeffs)
+{
+   int num_intervals = samples.size () - 1;     // N
+   vector< complex<double> > data (2*num_intervals);
+   for (int j=0; j<=num_intervals; j++)         // even extension
+   {
+     data[j] = samples[j];
+   }
+   for (int j=1; j<num_intervals; j++)
+   {
+     data[2*num_intervals - j] = samples[j];
+   }
+   fft (data);
+
+   coeffs.resize (num_intervals + 1);
+   for (int k=0; k<=num_intervals; k++)
+   {
+     coeffs[k] = data[k].real () / num_intervals;
+   }
+   coeffs[0] *= 0.5;
+   coeffs[num_intervals] *= 0.5;
+}
+
+// Integral over t from -1 to 1 of the series (odd T_k integrate to 0)
+static double series_integral (const vector<double> &coeffs)
+{
+   double sum = 0.;
+   for (size_t k=0; k<coeffs.size (); k+=2)
+   {
+     sum += coeffs[k] * 2. / (1. - double(k)*double(k));
+   }
+   return (sum);
+}
+
+// Sum of coeffs[k] T_k(t) by Clenshaw's recurrence
+static double clenshaw_sum (const vector<double> &coeffs, double t)
+{
+   double b1 = 0., b2 = 0.;
+   for (int k=coeffs.size () - 1; k>=1; k--)
+   {
+     double b0 = coeffs[k] + 2.*t*b1 - b2;
+     b2 = b1;
+     b1 = b0;
+   }
+   return (coeffs[0] + t*b1 - b2);
+}
+
+// In-place radix-2 FFT (the length must be a power of 2)
+static void fft (vector< complex<double> > &data)
+{
+   const double pi = 3.14159265358979323846;
+   int num = data.size ();
+
+   for (int i=1, j=0; i<num; i++)            // bit-reversal permutation
+   {
+     int bit = num >> 1;
+     for ( ; j & bit; bit >>= 1)
+     {
+       j ^= bit;
+     }
+     j ^= bit;
+     if (i < j)
+     {
+       swap (data[i], data[j]);
+     }
+   }
+
+   for (int length=2; length<=num; length<<=1)   // butterflies
+   {
+     for (int k=0; k<length/2; k++)
+     {
+       // twiddle factor computed directly (no build-up of round-off)
+       complex<double> w = polar (1., -2.*pi*k/length);
+       for (int start=0; start<num; start+=length)
+       {
+         complex<double> even = data[start + k];
+         complex<double> odd = w * data[start + k + length/2];
+         data[start + k] = even + odd;
+         data[start + k + length/2] = even - odd;
+       }
+     }
+   }
+}
@@ -0,0 +1,48 @@
+//  file: clenshaw_curtis.h
+//
+//  Header file for clenshaw_curtis.cpp: Clenshaw-Curtis (Chebyshev)
+//   integration, with the Chebyshev series of the integrand kept so it
+//   can be integrated again over any sub-range without new evaluations.
+//
+//  Revision History:
+//    17-Oct-2026 --- original version
+//
+//  Notes:
+//   * The integrand has the same form as for a gsl_function.
+//
+//************************************************************************
+
+#ifndef CLENSHAW_CURTIS_H
+#define CLENSHAW_CURTIS_H
+
+#include <vector>
+
+//  integrand f(x, params)
+typedef double (*cc_integrand_t) (double x, void *params);
+
+typedef struct                  // f(x) = sum of coeffs[k] T_k(t) for x
+{                               //  in [a,b], with t = (2x-a-b)/(b-a)
+  double a;
+  double b;
+  std::vector<double> coeffs;
+}
+chebyshev_series;
+
+//  begin: function prototypes
+
+                  // integral of f from a to b; returns 0 if the requested
+                  //  accuracy was reached, 1 if not.  If series_ptr is not
+                  //  NULL it gets the Chebyshev series of f on [a,b].
+extern int cc_integrate (cc_integrand_t f, void *params, double a, double b,
+                         double abs_error, double rel_error,
+                         double *result_ptr, double *error_ptr,
+                         long *num_evals_ptr, chebyshev_series *series_ptr);
+                  // integral of the series from c to d (inside [a,b])
+extern double chebyshev_integral (const chebyshev_series &series,
+                                  double c, double d);
+                  // value of the series at x
+extern double chebyshev_value (const chebyshev_series &series, double x);
+
+//  end: function prototypes
+
+#endif
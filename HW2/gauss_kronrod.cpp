@@ -0,0 +1,362 @@
+//  file: gauss_kronrod.cpp
+//
+//  Adaptive Gauss-Kronrod integration.  The subinterval with the largest
+//   error estimate is bisected until the total error is below the
+//   requested absolute or relative error (like gsl_integration_qag).
+//
+//  Revision history:
+//      17-Oct-2026  original version
+//
+//  Notes:
+//   * The subintervals are kept in a heap (largest error on top) inside
+//      a gk_workspace.  The workspace is allocated once by the caller;
+//      each integral just resets it, so there is no allocation per call.
+//   * Abscissas and weights of the 15- and 21-point Kronrod rules (and
+//      the embedded 7- and 10-point Gauss rules) are from QUADPACK.  The
+//      error estimate is |Kronrod - Gauss|, rescaled as in QUADPACK.
+//   * Semi-infinite integrals use x = a + (1-t)/t with t in (0,1], as
+//      gsl_integration_qagiu does.
+//   * compile with:  "g++ -Wall -c gauss_kronrod.cpp" or makefile
+//
+//************************************************************************
+
+// include files
+#include <cmath>
+#include <cfloat>
+#include "gauss_kronrod.h"   // prototypes and workspace definition
+
+// local definitions and helper functions
+
+// 15-point Kronrod abscissas (x >= 0, center last), weights, and the
+//  weights of the 7-point Gauss rule at xgk15[1], xgk15[3], ...
+static const double xgk15[8] = {
+  0.991455371120812639206854697526329,
+  0.949107912342758524526189684047851,
+  0.864864423359769072789712788640926,
+  0.741531185599394439863864773280788,
+  0.586087235467691130294144845693013,
+  0.405845151377397166906606412076961,
+  0.207784955007898467600689403773245,
+  0.000000000000000000000000000000000
+};
+static const double wgk15[8] = {
+  0.022935322010529224963732008058970,
+  0.063092092629978553290700663189204,
+  0.104790010322250183839876322541518,
+  0.140653259715525918745189590510238,
+  0.169004726639267902826583426598550,
+  0.190350578064785409913256402421014,
+  0.204432940075298892414161999234649,
+  0.209482141084727828012999174891714
+};
+static const double wg7[4] = {
+  0.129484966168869693270611432679082,
+  0.279705391489276667901467771423780,
+  0.381830050505118944950369775488975,
+  0.417959183673469387755102040816327
+};
+
+// 21-point Kronrod abscissas, weights, and 10-point Gauss weights
+static const double xgk21[11] = {
+  0.995657163025808080735527280689003,
+  0.973906528517171720077964012084452,
+  0.930157491355708226001207180059508,
+  0.865063366688984510732096688423493,
+  0.780817726586416897063717578345042,
+  0.679409568299024406234327365114874,
+  0.562757134668604683339000099272694,
+  0.433395394129247190799265943165784,
+  0.294392862701460198131126603103866,
+  0.148874338981631210884826001129720,
+  0.000000000000000000000000000000000
+};
+static const double wgk21[11] = {
+  0.011694638867371874278064396062192,
+  0.032558162307964727478818972459390,
+  0.054755896574351996031381300244580,
+  0.075039674810919952767043140916190,
+  0.093125454583697605535065465083366,
+  0.109387158802297641899210590325805,
+  0.123491976262065851077208980223048,
+  0.134709217311473325928054001771707,
+  0.142775938577060080797094273138717,
+  0.147739104901338491374841515972068,
+  0.149445554002916905664936468389821
+};
+static const double wg10[5] = {
+  0.066671344308688137593568809893332,
+  0.149451349150580593145776339657697,
+  0.219086362515982043995534934228163,
+  0.269266719309996355091226921569469,
+  0.295524224714752870173892994651338
+};
+
+typedef struct                // parameters for the transformed integrand
+{
+  gk_integrand_t f;
+  void *params;
+  double a;
+}
+upper_parameters;
+
+static void kronrod_rule (int rule, gk_integrand_t f, void *params,
+                          double a, double b, gk_interval *interval_ptr);
+static double rescale_error (double err, double result_abs,
+                             double result_asc);
+static double upper_integrand (double t, void *params);
+static void heap_push (gk_workspace *work_ptr, const gk_interval &interval);
+static gk_interval heap_pop (gk_workspace *work_ptr);
+
+//************************************************************************
+
+// Allocate a workspace for up to limit subintervals (NULL if limit < 1,
+//  as for gsl_integration_workspace_alloc: the whole interval needs one)
+gk_workspace *gk_workspace_alloc (int limit)
+{
+   if (limit < 1)
+   {
+     return (NULL);
+   }
+   gk_workspace *work_ptr = new gk_workspace;
+   work_ptr->limit = limit;
+   work_ptr->heap_ptr = new gk_interval[limit];
+   gk_workspace_reset (work_ptr);
+   return (work_ptr);
+}
+
+// Empty the workspace (no memory is freed or allocated)
+void gk_workspace_reset (gk_workspace *work_ptr)
+{
+   work_ptr->size = 0;
+   work_ptr->num_evals = 0;
+}
+
+void gk_workspace_free (gk_workspace *work_ptr)
+{
+   delete [] work_ptr->heap_ptr;
+   delete work_ptr;
+}
+
+//************************************************************************
+
+// Adaptive integration of f from a to b
+int gk_integrate (gk_integrand_t f, void *params, double a, double b,
+                  double abs_error, double rel_error, int rule,
+                  gk_workspace *work_ptr, double *result_ptr,
+                  double *error_ptr)
+{
+   const int evals_per_rule = (rule == GK_10_21) ? 21 : 15;
+   gk_workspace_reset (work_ptr);
+
+   gk_interval whole;
+   kronrod_rule (rule, f, params, a, b, &whole);
+   work_ptr->num_evals = evals_per_rule;
+   heap_push (work_ptr, whole);
+
+   double result = whole.result;        // running totals over intervals
+   double error = whole.error;
+   int status = 0;
+
+   while (error > fmax (abs_error, rel_error * fabs (result)))
+   {
+     if (work_ptr->size + 1 > work_ptr->limit)
+     {
+       status = 1;                      // no room to bisect again
+       break;
+     }
+     gk_interval worst = heap_pop (work_ptr);
+     double mid = 0.5 * (worst.a + worst.b);
+     if (mid <= worst.a || mid >= worst.b)  // can't split it any more
+     {
+       heap_push (work_ptr, worst);
+       status = 1;
+       break;
+     }
+
+     gk_interval left, right;
+     kronrod_rule (rule, f, params, worst.a, mid, &left);
+     kronrod_rule (rule, f, params, mid, worst.b, &right);
+     work_ptr->num_evals += 2 * evals_per_rule;
+     heap_push (work_ptr, left);
+     heap_push (work_ptr, right);
+
+     result += (left.result + right.result) - worst.result;
+     error += (left.error + right.error) - worst.error;
+   }
+
+   // add up the final subintervals (the running sums drift a little)
+   result = 0.;
+   error = 0.;
+   for (int i=0; i<work_ptr->size; i++)
+   {
+     result += work_ptr->heap_ptr[i].result;
+     error += work_ptr->heap_ptr[i].error;
+   }
+   *result_ptr = result;
+   *error_ptr = error;
+   return (status);
+}
+
+// Adaptive integration of f from a to infinity: the integral of
+//  f(a + (1-t)/t)/t^2 from t = 0 to 1
+int gk_integrate_upper (gk_integrand_t f, void *params, double a,
+                        double abs_error, double rel_error, int rule,
+                        gk_workspace *work_ptr, double *result_ptr,
+                        double *error_ptr)
+{
+   upper_parameters upper_params = { f, params, a };
+   return (gk_integrate (&upper_integrand, &upper_params, 0., 1.,
+                         abs_error, rel_error, rule, work_ptr,
+                         result_ptr, error_ptr));
+}
+
+//************************************************************************
+
+// Apply the Gauss-Kronrod rule to [a,b]: the Kronrod result, and the
+//  error estimate from the difference with the embedded Gauss rule
+static void kronrod_rule (int rule, gk_integrand_t f, void *params,
+                          double a, double b, gk_interval *interval_ptr)
+{
+   const double *xgk = xgk15, *wgk = wgk15, *wg = wg7;
+   int n = 8;                         // # of abscissas with x >= 0
+   if (rule == GK_10_21)
+   {
+     xgk = xgk21;
+     wgk = wgk21;
+     wg = wg10;
+     n = 11;
+   }
+   double fv1[10], fv2[10];           // f at center -/+ abscissa
+
+   double center = 0.5 * (a + b);
+   double half_length = 0.5 * (b - a);
+   double f_center = f (center, params);
+
+   double result_gauss = 0.;
+   double result_kronrod = f_center * wgk[n-1];
+   double result_abs = fabs (result_kronrod);
+   if (n % 2 == 0)                    // Gauss rule includes the center
+   {
+     result_gauss = f_center * wg[n/2 - 1];
+   }
+
+   for (int j=0; j<(n-1)/2; j++)      // points shared with Gauss rule
+   {
+     int jtw = 2*j + 1;
+     double abscissa = half_length * xgk[jtw];
+     double fval1 = f (center - abscissa, params);
+     double fval2 = f (center + abscissa, params);
+     fv1[jtw] = fval1;
+     fv2[jtw] = fval2;
+     result_gauss += wg[j] * (fval1 + fval2);
+     result_kronrod += wgk[jtw] * (fval1 + fval2);
+     result_abs += wgk[jtw] * (fabs (fval1) + fabs (fval2));
+   }
+   for (int j=0; j<n/2; j++)          // Kronrod-only points
+   {
+     int jtwm1 = 2*j;
+     double abscissa = half_length * xgk[jtwm1];
+     double fval1 = f (center - abscissa, params);
+     double fval2 = f (center + abscissa, params);
+     fv1[jtwm1] = fval1;
+     fv2[jtwm1] = fval2;
+     result_kronrod += wgk[jtwm1] * (fval1 + fval2);
+     result_abs += wgk[jtwm1] * (fabs (fval1) + fabs (fval2));
+   }
+
+   double mean = 0.5 * result_kronrod;
+   double result_asc = wgk[n-1] * fabs (f_center - mean);
+   for (int j=0; j<n-1; j++)
+   {
+     result_asc += wgk[j] * (fabs (fv1[j] - mean) + fabs (fv2[j] - mean));
+   }
+
+   double err = (result_kronrod - result_gauss) * half_length;
+   result_abs *= fabs (half_length);
+   result_asc *= fabs (half_length);
+
+   interval_ptr->a = a;
+   interval_ptr->b = b;
+   interval_ptr->result = result_kronrod * half_length;
+   interval_ptr->error = rescale_error (err, result_abs, result_asc);
+}
+
+// QUADPACK's error estimate: scale |Kronrod - Gauss| with the variation
+//  of the integrand, but never below what round-off allows
+static double rescale_error (double err, double result_abs,
+                             double result_asc)
+{
+   err = fabs (err);
+   if (result_asc != 0. && err != 0.)
+   {
+     double scale = pow ((200. * err / result_asc), 1.5);
+     err = (scale < 1.) ? result_asc * scale : result_asc;
+   }
+   if (result_abs > DBL_MIN / (50. * DBL_EPSILON))
+   {
+     double min_err = 50. * DBL_EPSILON * result_abs;
+     if (min_err > err)
+     {
+       err = min_err;
+     }
+   }
+   return (err);
+}
+
+// Integrand on t in (0,1] for the integral from a to infinity
+static double upper_integrand (double t, void *params)
+{
+   upper_parameters *upper_ptr = (upper_parameters *) params;
+   double x = upper_ptr->a + (1. - t) / t;
+   return (upper_ptr->f (x, upper_ptr->params) / (t * t));
+}
+
+//************************************************************************
+
+// Add an interval to the heap (largest error at heap_ptr[0])
+static void heap_push (gk_workspace *work_ptr, const gk_interval &interval)
+{
+   gk_interval *heap = work_ptr->heap_ptr;
+   int child = work_ptr->size++;
+   while (child > 0)                  // move up past smaller errors
+   {
+     int parent = (child - 1) / 2;
+     if (heap[parent].error >= interval.error)
+     {
+       break;
+     }
+     heap[child] = heap[parent];
+     child = parent;
+   }
+   heap[child] = interval;
+}
+
+// Remove and return the interval with the largest error
+static gk_interval heap_pop (gk_workspace *work_ptr)
+{
+   gk_interval *heap = work_ptr->heap_ptr;
+   gk_interval top = heap[0];
+   gk_interval last = heap[--work_ptr->size];
+   int size = work_ptr->size;
+
+   int parent = 0;
+   while (2*parent + 1 < size)        // move last down past larger errors
+   {
+     int child = 2*parent + 1;
+     if (child + 1 < size && heap[child+1].error > heap[child].error)
+     {
+       child++;
+     }
+     if (last.error >= heap[child].error)
+     {
+       break;
+     }
+     heap[parent] = heap[child];
+     parent = child;
+   }
+   if (size > 0)
+   {
+     heap[parent] = last;
+   }
+   return (top);
+}
@@ -0,0 +1,68 @@
+//  file: gauss_kronrod.h
+//
+//  Header file for gauss_kronrod.cpp: adaptive Gauss-Kronrod integration
+//   (like gsl_integration_qag and gsl_integration_qagiu) with a
+//   workspace that the caller allocates once and reuses.
+//
+//  Revision History:
+//    17-Oct-2026 --- original version
+//
+//  Notes:
+//   * The integrand has the same form as for a gsl_function, so the
+//      same functions can be passed to GSL and to these routines.
+//   * All of the memory for the subintervals is in the workspace, so
+//      repeated integrals with one workspace never allocate.
+//
+//************************************************************************
+
+#ifndef GAUSS_KRONROD_H
+#define GAUSS_KRONROD_H
+
+//  integrand f(x, params)
+typedef double (*gk_integrand_t) (double x, void *params);
+
+//  Gauss-Kronrod rules for each subinterval
+const int GK_7_15 = 1;          // 7-point Gauss, 15-point Kronrod
+const int GK_10_21 = 2;         // 10-point Gauss, 21-point Kronrod
+
+typedef struct                  // one subinterval and its estimates
+{
+  double a;                     // lower limit
+  double b;                     // upper limit
+  double result;                // Kronrod estimate of the integral
+  double error;                 // estimated absolute error
+}
+gk_interval;
+
+typedef struct                  // workspace (arena) for the subintervals
+{
+  int limit;                    // maximum number of subintervals
+  int size;                     // number of subintervals in use
+  gk_interval *heap_ptr;        // subintervals, largest error on top
+  long num_evals;               // # of integrand calls in the last integral
+}
+gk_workspace;
+
+//  begin: function prototypes
+
+                  // workspace for up to limit subintervals (NULL if
+                  //  limit < 1)
+extern gk_workspace *gk_workspace_alloc (int limit);
+extern void gk_workspace_reset (gk_workspace *work_ptr);
+extern void gk_workspace_free (gk_workspace *work_ptr);
+
+                  // integral of f from a to b; returns 0 if the requested
+                  //  accuracy was reached, 1 if the subdivision limit was hit
+extern int gk_integrate (gk_integrand_t f, void *params, double a, double b,
+                         double abs_error, double rel_error, int rule,
+                         gk_workspace *work_ptr,
+                         double *result_ptr, double *error_ptr);
+                  // integral of f from a to infinity (x = a + (1-t)/t)
+extern int gk_integrate_upper (gk_integrand_t f, void *params, double a,
+                               double abs_error, double rel_error, int rule,
+                               gk_workspace *work_ptr,
+                               double *result_ptr, double *error_ptr);
+
+//  end: function prototypes
+
+#endif
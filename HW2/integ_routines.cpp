@@ -8,6 +8,12 @@
 //      04-Jan-2004  original version, for 780.20 Computational Physics
 //      08-Jan-2005  function to be integrated now passed, changed names
 //      09-Jan-2011  new names and rearranged; fixed old bug
+//      17-Oct-2026  Simpson and Milne now evaluate the integrand in blocks
+//                    through a batch interface; old versions are wrappers
+//      17-Oct-2026  nested_integrator for Romberg refinement on nested grids
+//      17-Oct-2026  multi-threaded Simpson and Milne with compensated sums
+//      17-Oct-2026  Gauss-Legendre restored (in double precision), with the
+//                    points and weights for each order computed only once
 //
 //  Notes:
 //   * define with floats to emphasize round-off error  
@@ -16,13 +22,58 @@
 //             copyrighted by John Wiley and Sons, New York               
 //             code copyrighted by RH Landau  
 //   * equation for interval h = (b-a)/(N-1) with x_min=a and x_max=b
+//   * the batch routines apply the weights as a dot product over each
+//      block of points; add -march=native to the compile flags to let 
+//      the compiler use the full SIMD width of the machine
+//   * the parallel routines split the interior points into chunks of a
+//      fixed size, sum each chunk with Neumaier (compensated Kahan) 
+//      summation and add the chunks in order.  The chunks don't depend 
+//      on the number of threads, so neither does the result (to the bit).
+//      Compile and link with -pthread.
+//   * Gauss-Legendre points on [-1,1] are found by Newton's method using
+//      the Legendre recurrence relation.  They are saved in a table for
+//      each order, so later calls only pay for the integrand.
 // 
 //************************************************************************
 
 // include files
 #include <cmath>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <iostream>
+
 #include "integ_routines.h"   // integration routine prototypes 
 
+// local definitions and helper functions
+const int block_size = 256;   // # of abscissas passed to batch integrands 
+const int chunk_size = 64 * block_size;   // # of points per parallel task
+
+static void scalar_batch_integrand (int n, const double x[], double f[], 
+                                    void *params);
+static double dot_product (int n, const double w[], const double f[]);
+static double weighted_interior_sum (int num_pts, double x_min, 
+                                     double interval, const double weights[4],
+                                     batch_integrand_t integrand, void *params);
+static double endpoint_sum (double x_min, double x_max, 
+                            batch_integrand_t integrand, void *params);
+static void neumaier_add (double term, double &sum, double &correction);
+static double parallel_interior_sum (int num_pts, double x_min, 
+                                     double interval, const double weights[4],
+                                     batch_integrand_t integrand, void *params,
+                                     int num_threads);
+
+typedef struct                // Gauss-Legendre points and weights on [-1,1]
+{
+  std::vector<double> x;
+  std::vector<double> w;
+}
+legendre_table;
+
+static const legendre_table *legendre_points (int num_pts);
+
 //************************************************************************
 
 // Integration using trapezoid rule 
@@ -45,72 +96,446 @@ float trapezoid_rule ( int num_pts, float x_min, float x_max,
 
 //************************************************************************
 
-// Integration using Simpson's rule
+// Integration using Simpson's rule (scalar integrand, wraps the batch version)
 double simpsons_rule ( int num_pts, double x_min, double x_max, 
                       double (*integrand) (double x) )
+{  
+   return ( simpsons_rule_batch (num_pts, x_min, x_max, 
+                                 &scalar_batch_integrand, &integrand) );
+}  
+
+// Integration using Milne's rule (scalar integrand, wraps the batch version)
+double Milne_rule ( int num_pts, double x_min, double x_max, 
+                      double (*integrand) (double x) )
+{  
+   return ( Milne_rule_batch (num_pts, x_min, x_max, 
+                              &scalar_batch_integrand, &integrand) );
+}  
+
+//************************************************************************
+
+// Integration using Simpson's rule with a batch integrand
+double simpsons_rule_batch ( int num_pts, double x_min, double x_max, 
+                      batch_integrand_t integrand, void *params )
 {  
    double interval = ((x_max - x_min)/double(num_pts - 1));  // called h in notes
-   double sum=  0.;  // initialize integration sum to zero		 
+   // weights (in units of h) for points with n%4 = 0,1,2,3: 
+   //  4/3 for odd points and 2/3 for even points 
+   const double weights[4] = { 2./3., 4./3., 2./3., 4./3. };
    
-   for (int n=2; n<num_pts; n+=2)                // loop for odd points  
-   {
-     double x = x_min + interval * double(n-1);
-     sum += (4./3.)*interval * integrand(x);
-   }
-   for (int n=3; n<num_pts; n+=2)                // loop for even points  
-   {
-     double x = x_min + interval * double(n-1);
-     sum += (2./3.)*interval * integrand(x);
-   }   
+   double sum = weighted_interior_sum (num_pts, x_min, interval, weights,
+                                       integrand, params);
    // add in the endpoint contributions   
-   sum +=  (interval/3.) * (integrand(x_min) + integrand(x_max));	
+   sum += (1./3.) * endpoint_sum (x_min, x_max, integrand, params);	
    
-   return (sum);
+   return (interval * sum);
 }  
 
-double Milne_rule ( int num_pts, double x_min, double x_max, 
-                      double (*integrand) (double x) )
+// Integration using Milne's rule with a batch integrand
+double Milne_rule_batch ( int num_pts, double x_min, double x_max, 
+                      batch_integrand_t integrand, void *params )
 {  
    double interval = ((x_max - x_min)/double(num_pts - 1));  // called h in notes
-   double sum=  0.;  // initialize integration sum to zero		 
+   // weights (in units of h) for points with n%4 = 0,1,2,3: 
+   //  64/45 for odd points and alternating 28/45, 24/45 for even points
+   const double weights[4] = { 28./45., 64./45., 24./45., 64./45. };
+   
+   double sum = weighted_interior_sum (num_pts, x_min, interval, weights,
+                                       integrand, params);
+   // add in the endpoint contributions   
+   sum += (14./45.) * endpoint_sum (x_min, x_max, integrand, params);	
    
-   for (int n=2; n<num_pts; n+=2)                // loop for odd points  
+   return (interval * sum);
+}  
+
+//************************************************************************
+
+// Adapter so a plain double (*)(double) can be used as a batch integrand;
+//  params points to the function pointer
+static void scalar_batch_integrand (int n, const double x[], double f[], 
+                                    void *params)
+{
+   double (*integrand) (double x) = *((double (**) (double)) params);
+   for (int i=0; i<n; i++)
    {
-     double x = x_min + interval * double(n-1);
-     sum += (64./45.)*interval * integrand(x);
+     f[i] = integrand(x[i]);
    }
-   for (int n=3; n<num_pts; n+=4)                // loop for every other even point  
+}
+
+// Dot product of weights and function values.  Four partial sums break
+//  the dependence chain so the compiler can pipeline (and vectorize) it.
+static double dot_product (int n, const double w[], const double f[])
+{
+   double sum0 = 0., sum1 = 0., sum2 = 0., sum3 = 0.;
+   int i = 0;
+   for ( ; i+3<n; i+=4)
    {
-     double x = x_min + interval * double(n-1);
-     sum += (24./45.)*interval * integrand(x);
-   }   
-   for (int n=5; n<num_pts; n+=4)                // loop for the other even points  
+     sum0 += w[i] * f[i];
+     sum1 += w[i+1] * f[i+1];
+     sum2 += w[i+2] * f[i+2];
+     sum3 += w[i+3] * f[i+3];
+   }
+   for ( ; i<n; i++)                          // leftover points 
    {
-     double x = x_min + interval * double(n-1);
-     sum += (28./45.)*interval * integrand(x);
-   }   
-   // add in the endpoint contributions   
-   sum +=  (14./45.)*interval * (integrand(x_min) + integrand(x_max));	
+     sum0 += w[i] * f[i];
+   }
+   return ((sum0 + sum1) + (sum2 + sum3));
+}
+
+// Sum of weight*integrand over the interior points n = 1,...,num_pts-2 
+//  (counting from n=0 at x_min), with weights that repeat every 4 points.
+//  The points are handed to the integrand in blocks of block_size; 
+//  since block_size is a multiple of 4 every block has the same weights.
+static double weighted_interior_sum (int num_pts, double x_min, 
+                                     double interval, const double weights[4],
+                                     batch_integrand_t integrand, void *params)
+{
+   double x[block_size], f[block_size], w[block_size];
+   for (int i=0; i<block_size; i++)     // block starts at n = 1 (mod 4) 
+   {
+     w[i] = weights[(i+1)%4];
+   }
    
+   double sum = 0.;
+   for (int first=1; first<num_pts-1; first+=block_size)
+   {
+     int count = num_pts - 1 - first;        // points left in the interior
+     if (count > block_size) count = block_size;
+     for (int i=0; i<count; i++)
+     {
+       x[i] = x_min + interval * double(first+i);
+     }
+     integrand (count, x, f, params);
+     sum += dot_product (count, w, f);
+   }
    return (sum);
+}
+
+// Compensated (Neumaier) summation: add term to sum, keeping the 
+//  low-order bits that are lost in correction
+static void neumaier_add (double term, double &sum, double &correction)
+{
+   double new_sum = sum + term;
+   if (fabs (sum) >= fabs (term))
+   {
+     correction += (sum - new_sum) + term;
+   }
+   else
+   {
+     correction += (term - new_sum) + sum;
+   }
+   sum = new_sum;
+}
+
+// Same as weighted_interior_sum, but the interior points are split into
+//  chunks of chunk_size that threads pick up one at a time.  Each chunk
+//  is summed with compensation into its own slot and the slots are 
+//  combined in order at the end.
+static double parallel_interior_sum (int num_pts, double x_min, 
+                                     double interval, const double weights[4],
+                                     batch_integrand_t integrand, void *params,
+                                     int num_threads)
+{
+   int num_interior = num_pts - 2;
+   if (num_interior <= 0)
+   {
+     return (0.);
+   }
+   int num_chunks = (num_interior + chunk_size - 1) / chunk_size;
+   if (num_threads <= 0)
+   {
+     num_threads = int (std::thread::hardware_concurrency ());
+   }
+   if (num_threads < 1) num_threads = 1;
+   if (num_threads > num_chunks) num_threads = num_chunks;
+
+   std::vector<double> chunk_sums (num_chunks);
+   std::atomic<int> next_chunk (0);
+
+   // each worker takes the next unclaimed chunk until none are left 
+   auto worker = [&] ()
+   {
+     double x[block_size], f[block_size], w[block_size];
+     for (int i=0; i<block_size; i++)   // chunks start at n = 1 (mod 4) 
+     {
+       w[i] = weights[(i+1)%4];
+     }
+     int chunk;
+     while ((chunk = next_chunk++) < num_chunks)
+     {
+       int first_pt = 1 + chunk * chunk_size;
+       int last_pt = first_pt + chunk_size;          // one past the end 
+       if (last_pt > num_pts - 1) last_pt = num_pts - 1;
+
+       double sum = 0., correction = 0.;
+       for (int first=first_pt; first<last_pt; first+=block_size)
+       {
+         int count = last_pt - first;
+         if (count > block_size) count = block_size;
+         for (int i=0; i<count; i++)
+         {
+           x[i] = x_min + interval * double(first+i);
+         }
+         integrand (count, x, f, params);
+         for (int i=0; i<count; i++)
+         {
+           neumaier_add (w[i] * f[i], sum, correction);
+         }
+       }
+       chunk_sums[chunk] = sum + correction;
+     }
+   };
+
+   std::vector<std::thread> threads;
+   for (int t=1; t<num_threads; t++)      // this thread is worker 0 
+   {
+     threads.push_back (std::thread (worker));
+   }
+   worker ();
+   for (size_t t=0; t<threads.size (); t++)
+   {
+     threads[t].join ();
+   }
+
+   double sum = 0., correction = 0.;      // combine in a fixed order 
+   for (int chunk=0; chunk<num_chunks; chunk++)
+   {
+     neumaier_add (chunk_sums[chunk], sum, correction);
+   }
+   return (sum + correction);
+}
+
+// Sum of the integrand at the two endpoints
+static double endpoint_sum (double x_min, double x_max, 
+                            batch_integrand_t integrand, void *params)
+{
+   double x[2] = { x_min, x_max };
+   double f[2];
+   integrand (2, x, f, params);
+   return (f[0] + f[1]);
+}
+
+//************************************************************************
+
+// Multi-threaded Simpson's rule with a batch integrand
+double simpsons_rule_parallel ( int num_pts, double x_min, double x_max, 
+                      batch_integrand_t integrand, void *params, 
+                      int num_threads )
+{  
+   double interval = ((x_max - x_min)/double(num_pts - 1));  // called h in notes
+   const double weights[4] = { 2./3., 4./3., 2./3., 4./3. };
+   
+   double sum = parallel_interior_sum (num_pts, x_min, interval, weights,
+                                       integrand, params, num_threads);
+   sum += (1./3.) * endpoint_sum (x_min, x_max, integrand, params);	
+   
+   return (interval * sum);
 }  
 
+// Multi-threaded Milne's rule with a batch integrand
+double Milne_rule_parallel ( int num_pts, double x_min, double x_max, 
+                      batch_integrand_t integrand, void *params, 
+                      int num_threads )
+{  
+   double interval = ((x_max - x_min)/double(num_pts - 1));  // called h in notes
+   const double weights[4] = { 28./45., 64./45., 24./45., 64./45. };
+   
+   double sum = parallel_interior_sum (num_pts, x_min, interval, weights,
+                                       integrand, params, num_threads);
+   sum += (14./45.) * endpoint_sum (x_min, x_max, integrand, params);	
+   
+   return (interval * sum);
+}  
 
+//************************************************************************
+
+// nested_integrator: start from the trapezoid rule with the two endpoints
+nested_integrator::nested_integrator (double x_min, double x_max, 
+                                      batch_integrand_t integrand, 
+                                      void *params)
+  : x_min_(x_min), x_max_(x_max), integrand_(integrand), params_(params),
+    scalar_integrand_(NULL)
+{
+   start ();
+}
+
+nested_integrator::nested_integrator (double x_min, double x_max, 
+                                      double (*integrand) (double x))
+  : x_min_(x_min), x_max_(x_max), integrand_(&scalar_batch_integrand), 
+    params_(NULL), scalar_integrand_(integrand)
+{
+   params_ = &scalar_integrand_;   // the adapter gets the function this way
+   start ();
+}
+
+void nested_integrator::start ()
+{
+   level_ = 0;
+   num_evals_ = 2;
+   row_[0] = 0.5 * (x_max_ - x_min_) * endpoint_sum (x_min_, x_max_, 
+                                                     integrand_, params_);
+   last_row_[0] = row_[0];
+}
+
+// Halve the interval: T(h/2) = T(h)/2 + (h/2) * sum of f at the midpoints,
+//  then extend the Romberg tableau by one column.
+void nested_integrator::refine ()
+{
+   if (level_ >= max_level)
+   {
+     return;                     // can't refine any further 
+   }
+   int num_new = 1 << level_;    // number of new midpoints 
+   double interval = (x_max_ - x_min_) / double(2 * num_new);  // new h 
+
+   double x[block_size], f[block_size];
+   double sum = 0.;
+   for (int first=0; first<num_new; first+=block_size)
+   {
+     int count = num_new - first;
+     if (count > block_size) count = block_size;
+     for (int i=0; i<count; i++)            // odd multiples of new h 
+     {
+       x[i] = x_min_ + interval * double(2*(first+i) + 1);
+     }
+     integrand_ (count, x, f, params_);
+     for (int i=0; i<count; i++)
+     {
+       sum += f[i];
+     }
+   }
+   num_evals_ += num_new;
+
+   for (int m=0; m<=level_; m++)
+   {
+     last_row_[m] = row_[m];
+   }
+   level_++;
+   row_[0] = 0.5 * last_row_[0] + interval * sum;
+   double factor = 1.;
+   for (int m=1; m<=level_; m++)       // Richardson extrapolation 
+   {
+     factor *= 4.;
+     row_[m] = row_[m-1] + (row_[m-1] - last_row_[m-1]) / (factor - 1.);
+   }
+}
+
+// Difference between the best estimates at the last two levels
+double nested_integrator::romberg_error () const
+{
+   if (level_ == 0)
+   {
+     return (fabs (row_[0]));     // nothing to compare with yet 
+   }
+   return (fabs (row_[level_] - last_row_[level_-1]));
+}
 
 //************************************************************************
 
 // Integration using Gauss quadrature rule  
-//float gauss_quadrature ( int num_pts, float x_min, float x_max, 
-                         //float (*integrand) (float x) )
-//{
-   //float quadra = 0.;
-   //double weight[1000], x[1000];             // for points and weights 
-   
-   //gauss (num_pts, 0, x_min, x_max, x, weight);     // returns Legendre 
-                                                    //  points and weights 
-   //for (int n=0; n< num_pts; n++)
-   //{                               
-   //   quadra += integrand(x[n])*weight[n];      // calculating the integral 
-   //}   
-   //return (quadra);                  
-//}
+double gauss_quadrature ( int num_pts, double x_min, double x_max, 
+                          double (*integrand) (double x) )
+{
+   if (num_pts <= 0)
+   {
+     return (0.);                   // no points, no integral 
+   }
+   const legendre_table *table_ptr = legendre_points (num_pts);
+   double center = 0.5 * (x_max + x_min);
+   double half_width = 0.5 * (x_max - x_min);
+   double quadra = 0.;
+
+   for (int n=0; n< num_pts; n++)
+   {                               
+     quadra += integrand(center + half_width * table_ptr->x[n]) 
+                 * table_ptr->w[n];        // calculating the integral 
+   }   
+   return (half_width * quadra);                  
+}
+
+//************************************************************************
+
+// Gauss-Legendre points x[] and weights w[] for npts points, mapped 
+//  according to job (see integ_routines.h), as in Landau and Paez
+void gauss (int npts, int job, double a, double b, double x[], double w[])
+{
+   if (npts <= 0)
+   {
+     return;                        // nothing to fill in 
+   }
+   const legendre_table *table_ptr = legendre_points (npts);
+
+   for (int i=0; i<npts; i++)
+   {
+     double xi = table_ptr->x[i];
+     double wi = table_ptr->w[i];
+     switch (job)
+     {
+       case 0:                       // uniform rescaling to [a,b] 
+         x[i] = xi*(b-a)/2. + (b+a)/2.;
+         w[i] = wi*(b-a)/2.;
+         break;
+       case 1:                       // [0,b] 
+         x[i] = a*b*(1.+xi) / (b+a-(b-a)*xi);
+         w[i] = wi*2.*a*b*b / ((b+a-(b-a)*xi)*(b+a-(b-a)*xi));
+         break;
+       case 2:                       // [a,infinity) 
+         x[i] = (b*xi + b + a + a) / (1.-xi);
+         w[i] = wi*2.*(a+b) / ((1.-xi)*(1.-xi));
+         break;
+       default:
+         std::cout << "gauss: job must be 0, 1 or 2\n";
+         return;
+     }
+   }
+}
+
+//************************************************************************
+
+// Table of Gauss-Legendre points and weights on [-1,1] for num_pts points.
+//  Each order is computed once (Newton's method on the Legendre 
+//  recurrence) and saved; the lock makes this safe to call from threads.
+static const legendre_table *legendre_points (int num_pts)
+{
+   static std::map<int, legendre_table> tables;   // saved tables by order 
+   static std::mutex tables_lock;
+   std::lock_guard<std::mutex> guard (tables_lock);
+
+   std::map<int, legendre_table>::iterator found = tables.find (num_pts);
+   if (found != tables.end ())
+   {
+     return (&found->second);
+   }
+
+   legendre_table &table = tables[num_pts];
+   table.x.resize (num_pts);
+   table.w.resize (num_pts);
+   const double eps = 3.e-16;           // convergence of Newton's method 
+   const double pi = 3.14159265358979323846;
+
+   for (int i=0; i<(num_pts+1)/2; i++)  // points are symmetric about 0 
+   {
+     double z = cos (pi*(double(i)+0.75)/(double(num_pts)+0.5)); // guess 
+     double z_old, deriv;
+     int iterations = 0;
+     do
+     {
+       double p1 = 1., p2 = 0.;         // P_j(z) and P_{j-1}(z) 
+       for (int j=1; j<=num_pts; j++)   // recurrence up to P_N(z) 
+       {
+         double p3 = p2;
+         p2 = p1;
+         p1 = ((2.*j-1.)*z*p2 - (j-1.)*p3) / j;
+       }
+       deriv = num_pts * (z*p1 - p2) / (z*z - 1.);   // P_N'(z) 
+       z_old = z;
+       z = z_old - p1/deriv;            // Newton step 
+     } while (fabs (z - z_old) > eps && ++iterations < 100);
+
+     table.x[i] = -z;
+     table.x[num_pts-1-i] = z;
+     table.w[i] = 2. / ((1.-z*z) * deriv*deriv);
+     table.w[num_pts-1-i] = table.w[i];
+   }
+   return (&table);
+}
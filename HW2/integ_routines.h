@@ -9,11 +9,65 @@
 //    05-Jan-2004 --- original version, based on C version
 //    08-Jan-2005 --- function to be integrated now passed, changed names
 //    09-Jan-2011 --- changed function names
+//    17-Oct-2026 --- added batch integrand versions of Simpson and Milne
+//    17-Oct-2026 --- added nested_integrator (Romberg refinement)
+//    17-Oct-2026 --- added multi-threaded Simpson and Milne rules
+//    17-Oct-2026 --- restored Gauss-Legendre (gauss_quadrature and gauss)
 //
 //  To do:
 //
 //************************************************************************
 
+//  batch integrand: fill f[i] = integrand(x[i]) for i = 0,...,n-1.
+//   The integration routines hand over blocks of abscissas at once, so 
+//   the loop over x[] can be inlined and vectorized by the compiler.
+//   The void pointer passes any parameters (like a gsl_function).
+typedef void (*batch_integrand_t) (int n, const double x[], double f[],
+                                   void *params);
+
+//  Incremental integration on nested grids with 2^level + 1 points.
+//   Each call to refine() halves the interval h and evaluates the 
+//   integrand only at the new midpoints, so every earlier function value
+//   is reused.  The trapezoid sums feed a Romberg tableau, whose first 
+//   two extrapolated columns are exactly Simpson's and Milne's rules.
+//   A convergence sweep over levels 0..L costs as much as one integral
+//   with 2^L + 1 points.
+class nested_integrator
+{
+  public:
+    nested_integrator (double x_min, double x_max, 
+                       batch_integrand_t integrand, void *params);
+    nested_integrator (double x_min, double x_max, 
+                       double (*integrand) (double x));
+    // not copyable (the scalar form points params_ at this object)
+    nested_integrator (const nested_integrator &) = delete;
+    nested_integrator &operator= (const nested_integrator &) = delete;
+
+    void refine ();                   // halve the interval 
+    int level () const { return level_; }
+    int num_pts () const { return (1 << level_) + 1; }
+    long num_evals () const { return num_evals_; }
+
+    double trapezoid () const { return row_[0]; }   // any level 
+    double simpsons () const { return row_[1]; }    // level >= 1 
+    double Milne () const { return row_[2]; }       // level >= 2 
+    double romberg () const { return row_[level_]; } // highest order 
+    double romberg_error () const;    // estimate from last two levels 
+
+  private:
+    static const int max_level = 30;  // num_pts still fits in an int 
+    double x_min_, x_max_;
+    batch_integrand_t integrand_;
+    void *params_;
+    double (*scalar_integrand_) (double x);  // only for the scalar form
+    int level_;
+    long num_evals_;
+    double row_[max_level+1];         // current row of Romberg tableau 
+    double last_row_[max_level+1];    // previous row 
+
+    void start ();
+};
+
 //  begin: function prototypes 
  
 //extern float trapezoid_rule ( int num_pts, float x_min, float x_max, 
@@ -22,10 +76,27 @@ extern double simpsons_rule ( int num_pts, double x_min, double x_max,
                        double (*integrand) (double x) );    // Simpson's rule 
 extern double Milne_rule ( int num_pts, double x_min, double x_max, 
                        double (*integrand) (double x) );    // Milne rule 
-//extern float gauss_quadrature( int num_pts, float x_min, float x_max, 
-                       //float (*integrand) (float x) );    // Gauss' rule 
+extern double simpsons_rule_batch ( int num_pts, double x_min, double x_max, 
+                       batch_integrand_t integrand, void *params );
+extern double Milne_rule_batch ( int num_pts, double x_min, double x_max, 
+                       batch_integrand_t integrand, void *params );
+                       // multi-threaded versions; num_threads <= 0 means 
+                       //  use all cores.  The integrand must be thread safe.
+extern double simpsons_rule_parallel ( int num_pts, double x_min, 
+                       double x_max, batch_integrand_t integrand, 
+                       void *params, int num_threads );
+extern double Milne_rule_parallel ( int num_pts, double x_min, double x_max, 
+                       batch_integrand_t integrand, void *params, 
+                       int num_threads );
+extern double gauss_quadrature( int num_pts, double x_min, double x_max, 
+                       double (*integrand) (double x) );    // Gauss' rule 
    
-//extern void gauss(int npts, int job, double a, double b, 
-                  //double x[], double w[]);              // from gauss.cpp 
+                  // Gauss-Legendre points and weights for npts points
+                  //  (nothing for npts <= 0; gauss_quadrature gives 0):
+                  //  job = 0: on [a,b] 
+                  //  job = 1: on [0,b] with half the points in [0,ab/(a+b)]
+                  //  job = 2: on [a,inf) with half the points in [a,b+2a]
+extern void gauss(int npts, int job, double a, double b, 
+                  double x[], double w[]);
 
 //  end: function prototypes 
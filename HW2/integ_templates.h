@@ -0,0 +1,123 @@
+//  file: integ_templates.h
+//
+//  Template versions of the trapezoid, Simpson and Milne rules from
+//   integ_routines.cpp.  The integrand can be any callable (function,
+//   lambda, functor with captured parameters) and the precision is a
+//   template parameter (float, double or long double).
+//
+//  Revision History:
+//    17-Oct-2026 --- original version
+//
+//  Notes:
+//   * Because everything is in the header, the compiler sees the
+//      integrand and can inline it and vectorize the loop over points.
+//   * The interior points are summed in independent "lanes" (one SIMD
+//      register wide: 8 floats or 4 doubles for AVX), with the weights
+//      applied to each lane sum at the end.  So float gets twice the
+//      lanes of double.
+//   * usage:
+//       double result = simpsons_rule_inline (101, 0., 1.,
+//                                  [] (double x) { return exp(-x*x); });
+//
+//************************************************************************
+
+#ifndef INTEG_TEMPLATES_H
+#define INTEG_TEMPLATES_H
+
+//  number of lanes for precision Real (a 32-byte register, at least 4)
+template <typename Real>
+struct simd_lanes
+{
+  static const int value = (32/sizeof(Real) >= 4) ? 32/sizeof(Real) : 4;
+};
+
+//  Sum of weights[n%4]*integrand(x_n) over the interior points
+//   n = 1,...,num_pts-2 (counting from n=0 at x_min).  Lane i holds the
+//   points with n = i+1 (mod lanes); lanes is a multiple of 4, so every
+//   point in a lane has the same weight.
+template <typename Real, typename Function>
+Real weighted_interior_sum_inline (int num_pts, Real x_min, Real interval,
+                                   const Real weights[4],
+                                   const Function &integrand)
+{
+  const int lanes = simd_lanes<Real>::value;
+  Real lane_sum[lanes];
+  for (int i=0; i<lanes; i++)
+  {
+    lane_sum[i] = Real(0);
+  }
+
+  int n = 1;
+  for ( ; n+lanes <= num_pts-1; n+=lanes)     // full sets of lanes
+  {
+    for (int i=0; i<lanes; i++)
+    {
+      lane_sum[i] += integrand (x_min + interval * Real(n+i));
+    }
+  }
+  for (int i=0; n+i < num_pts-1; i++)        // leftover points
+  {
+    lane_sum[i] += integrand (x_min + interval * Real(n+i));
+  }
+
+  Real sum = Real(0);
+  for (int i=0; i<lanes; i++)
+  {
+    sum += weights[(i+1)%4] * lane_sum[i];
+  }
+  return (sum);
+}
+
+//************************************************************************
+
+// Integration using trapezoid rule
+template <typename Real, typename Function>
+Real trapezoid_rule_inline (int num_pts, Real x_min, Real x_max,
+                            const Function &integrand)
+{
+  Real interval = (x_max - x_min)/Real(num_pts - 1);  // called h in notes
+  const Real weights[4] = { Real(1), Real(1), Real(1), Real(1) };
+
+  Real sum = weighted_interior_sum_inline (num_pts, x_min, interval,
+                                           weights, integrand);
+  // add in the endpoint contributions
+  sum += Real(0.5) * (integrand (x_min) + integrand (x_max));
+
+  return (interval * sum);
+}
+
+// Integration using Simpson's rule (num_pts odd)
+template <typename Real, typename Function>
+Real simpsons_rule_inline (int num_pts, Real x_min, Real x_max,
+                           const Function &integrand)
+{
+  Real interval = (x_max - x_min)/Real(num_pts - 1);  // called h in notes
+  const Real weights[4] = { Real(2)/Real(3), Real(4)/Real(3),
+                            Real(2)/Real(3), Real(4)/Real(3) };
+
+  Real sum = weighted_interior_sum_inline (num_pts, x_min, interval,
+                                           weights, integrand);
+  // add in the endpoint contributions
+  sum += (Real(1)/Real(3)) * (integrand (x_min) + integrand (x_max));
+
+  return (interval * sum);
+}
+
+// Integration using Milne's rule (num_pts = 4k + 1)
+template <typename Real, typename Function>
+Real Milne_rule_inline (int num_pts, Real x_min, Real x_max,
+                        const Function &integrand)
+{
+  Real interval = (x_max - x_min)/Real(num_pts - 1);  // called h in notes
+  const Real weights[4] = { Real(28)/Real(45), Real(64)/Real(45),
+                            Real(24)/Real(45), Real(64)/Real(45) };
+
+  Real sum = weighted_interior_sum_inline (num_pts, x_min, interval,
+                                           weights, integrand);
+  // add in the endpoint contributions
+  sum += (Real(14)/Real(45)) * (integrand (x_min) + integrand (x_max));
+
+  return (interval * sum);
+}
+
+#endif
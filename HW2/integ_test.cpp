@@ -20,6 +20,15 @@
 // Patrick Johns
 // johnspat@msu.edu
 // 2/27/2019 added gsl integration routine.
+// 10/17/2026 the Simpson and Milne sweeps use the batch integrand interface.
+// 10/17/2026 added a nested-grid (Romberg) sweep that reuses function values.
+// 10/17/2026 compare serial and multi-threaded compensated Milne at large N.
+// 10/17/2026 added a Gauss-Legendre sweep (Gauss.dat).
+// 10/17/2026 added float/double/long double trapezoid sweep (Trapezoid.dat).
+// 10/17/2026 compare the GSL result with the in-project Gauss-Kronrod routine.
+// 10/17/2026 added tanh-sinh results on [0,1] and [0,infinity).
+// 10/17/2026 added Clenshaw-Curtis, including re-integration over [0,1/2].
+// 10/17/2026 added Monte Carlo and quasi-Monte Carlo for the same integral in 3d.
 // Discussion on the plot: The plot of the relative error between the integration technique and the number of intervals
 // for Milne's and Simpson's method included 2 regions. The relative error for both would decrease linearly(on a log-log plot) 
 // and then change to mostly noise afterwards. The linear relationship for Simpson's method had a slope of -4.03508(fitted by
@@ -43,10 +52,17 @@
 using namespace std;
 
 #include "integ_routines.h"	// prototypes for integration routines
+#include "integ_templates.h"	// template versions taking any callable
+#include "gauss_kronrod.h"	// adaptive Gauss-Kronrod integration
+#include "tanh_sinh.h"		// double-exponential integration
+#include "clenshaw_curtis.h"	// Clenshaw-Curtis (Chebyshev) integration
+#include "monte_carlo.h"	// Monte Carlo in d dimensions
 #include <gsl/gsl_integration.h> // for gsl integration routine
 
 double my_integrand (double x);
 double my_gsl_integrand (double x, void *);
+void my_batch_integrand (int n, const double x[], double f[], void *);
+double my_mc_integrand (const double x[], void *params);
 
 
 //************************************************************************
@@ -75,6 +91,60 @@ main ()
 			abs_error, rel_error, 1000, work_ptr, &gslresult,
 			&error);
 
+  // the same integral with the adaptive Gauss-Kronrod routine; the 
+  //  workspace is allocated once and reused for every integral
+  gk_workspace *gk_work_ptr = gk_workspace_alloc (1000);
+  double gk_result, gk_error;
+  gk_integrate (&my_gsl_integrand, NULL, lower, upper, abs_error, rel_error,
+                GK_10_21, gk_work_ptr, &gk_result, &gk_error);
+  cout << setprecision(15) << "GSL qags: " << gslresult 
+       << "  Gauss-Kronrod: " << gk_result << " (" << gk_work_ptr->num_evals
+       << " evaluations)" << endl;
+  gk_workspace_free (gk_work_ptr);
+
+  // and with the tanh-sinh rule, which also does [0,infinity) directly
+  double ts_result, ts_error;
+  long ts_evals;
+  ts_integrate (&my_gsl_integrand, NULL, lower, upper, abs_error,
+                rel_error, &ts_result, &ts_error, &ts_evals);
+  cout << "tanh-sinh: " << ts_result << " (" << ts_evals 
+       << " evaluations)" << endl;
+  ts_integrate_upper (&my_gsl_integrand, NULL, lower, abs_error,
+                      rel_error, &ts_result, &ts_error, &ts_evals);
+  cout << "exp-sinh from 0 to infinity: " << ts_result << " vs. sqrt(pi)/2 = "
+       << sqrt (M_PI)/2. << " (" << ts_evals << " evaluations)" << endl;
+
+  // and with Clenshaw-Curtis; the Chebyshev series it returns gives the
+  //  integral over [0,1/2] with no more evaluations
+  double cc_result, cc_error;
+  long cc_evals;
+  chebyshev_series my_series;
+  cc_integrate (&my_gsl_integrand, NULL, lower, upper, abs_error, rel_error,
+                &cc_result, &cc_error, &cc_evals, &my_series);
+  cout << "Clenshaw-Curtis: " << cc_result << " (" << cc_evals 
+       << " evaluations)" << endl;
+  cout << "from 0 to 1/2: " << chebyshev_integral (my_series, 0., 0.5)
+       << " vs. sqrt(pi)/2 erf(1/2) = " << sqrt (M_PI)/2. * erf (0.5) << endl;
+
+  // exp(-(x^2+y^2+z^2)) over the unit cube is answer^3; plain Monte Carlo
+  //  vs. shifted Halton points, to a relative error of 1e-4 (all cores)
+  int mc_dim = 3;
+  double mc_lower[3] = {lower, lower, lower};
+  double mc_upper[3] = {upper, upper, upper};
+  const char *mc_names[2] = {"Monte Carlo", "quasi-Monte Carlo"};
+  int mc_methods[2] = {MC_PLAIN, MC_HALTON};
+  for (int m = 0; m < 2; m++)
+  {
+    double mc_result, mc_error;
+    long mc_samples;
+    mc_integrate (&my_mc_integrand, &mc_dim, mc_dim, mc_lower, mc_upper,
+                  mc_methods[m], 0., 1.e-4, 100000000, 1234, 0,
+                  &mc_result, &mc_error, &mc_samples);
+    cout << mc_names[m] << " in 3d: " << mc_result << " +/- " << mc_error
+         << " vs. " << answer*answer*answer << " (" << mc_samples 
+         << " evaluations)" << endl;
+  }
+
   // open the output file stream
   ofstream Simpsons_out ("Simpsons.dat");	// save data in Simpsons.dat
   Simpsons_out << "#N                        Simpsons                     GSL " << endl;
@@ -85,13 +155,13 @@ main ()
   {
     Simpsons_out << setw(4) << log10(i);
 
-    result = simpsons_rule (i, lower, upper, &my_integrand);
+    result = simpsons_rule_batch (i, lower, upper, &my_batch_integrand, NULL);
     Simpsons_out << setprecision(15) << "  " << scientific << log10(fabs ((result - answer)/(answer))) << "  " <<
 	log10(fabs ((gslresult - answer)/(answer)));
 
     Simpsons_out << endl;
   }
-  cout << "data stored";
+  cout << "data stored" << endl;
   Simpsons_out.close ();
   // Milne's rule requires 4i + 1 intervals.
   
@@ -102,13 +172,84 @@ main ()
   {
     Milne_out << setw(4) << log10(i);
 
-    result = Milne_rule (i, lower, upper, &my_integrand);
+    result = Milne_rule_batch (i, lower, upper, &my_batch_integrand, NULL);
     Milne_out << setprecision(15) << "  " << scientific << log10(fabs ((result - answer)/(answer))) << "  " <<
 	log10(fabs ((gslresult - answer)/(answer)));
 
     Milne_out << endl;
   }
   Milne_out.close ();
+
+  // The same convergence curves on nested grids with 2^k + 1 points.
+  //  Each level reuses all earlier function values, so the whole sweep 
+  //  costs as much as the finest integral alone.
+  const int max_level = 16;	// finest grid has 2^16 + 1 points 
+  nested_integrator nested (lower, upper, &my_batch_integrand, NULL);
+
+  ofstream Nested_out ("Nested.dat");	// save data in Nested.dat
+  Nested_out << "#N                        Simpsons                   Milne"
+             << "                     Romberg " << endl;
+  Nested_out << "#-----------------------------------------" << endl;
+  while (nested.level () < max_level)
+  {
+    nested.refine ();
+    Nested_out << setw(4) << log10(nested.num_pts ());
+    Nested_out << setprecision(15) << "  " << scientific 
+      << log10(fabs ((nested.simpsons () - answer)/(answer)));
+    if (nested.level () >= 2)           // Milne needs 4k + 1 points 
+    {
+      Nested_out << "  " << log10(fabs ((nested.Milne () - answer)/(answer)))
+        << "  " << log10(fabs ((nested.romberg () - answer)/(answer)));
+    }
+    Nested_out << endl;
+  }
+  Nested_out.close ();
+  cout << "nested sweep used " << nested.num_evals () 
+       << " function evaluations" << endl;
+
+  // Gauss-Legendre converges exponentially for this smooth integrand 
+  //  (the points and weights for each N are only computed once)
+  ofstream Gauss_out ("Gauss.dat");	// save data in Gauss.dat
+  Gauss_out << "#N                        Gauss " << endl;
+  Gauss_out << "#-----------------------------------------" << endl;
+  for (int i = 1; i <= 30; i++)
+  {
+    result = gauss_quadrature (i, lower, upper, &my_integrand);
+    Gauss_out << setw(4) << log10(i) << setprecision(15) << "  " 
+      << scientific << log10(fabs ((result - answer)/(answer))) << endl;
+  }
+  Gauss_out.close ();
+
+  // Round-off in single, double and extended precision: the template
+  //  trapezoid rule with the integrand as a lambda (inlined by the compiler)
+  auto gaussian = [] (auto x) { return exp (-x*x); };
+  ofstream Trapezoid_out ("Trapezoid.dat");	// save data in Trapezoid.dat
+  Trapezoid_out << "#N                        float                     double"
+                << "                    long double " << endl;
+  Trapezoid_out << "#-----------------------------------------" << endl;
+  for (int i = 3; i <= 2*max_intervals; i = 2*i - 1)
+  {
+    float float_result = trapezoid_rule_inline (i, 0.f, 1.f, gaussian);
+    double double_result = trapezoid_rule_inline (i, lower, upper, gaussian);
+    long double long_result = trapezoid_rule_inline (i, 0.L, 1.L, gaussian);
+    Trapezoid_out << setw(4) << log10(i) << setprecision(15) << "  " 
+      << scientific << log10(fabs ((float_result - answer)/(answer))) << "  "
+      << log10(fabs ((double_result - answer)/(answer))) << "  "
+      << log10(fabs ((long_result - answer)/(answer))) << endl;
+  }
+  Trapezoid_out.close ();
+
+  // Past the round-off knee: compare the plain running sum with the 
+  //  multi-threaded, compensated sum (all cores) at a large N.
+  const int big_pts = 4*10000000 + 1;	// Milne needs 4k + 1 points 
+  double serial_result = Milne_rule_batch (big_pts, lower, upper, 
+                                           &my_batch_integrand, NULL);
+  double parallel_result = Milne_rule_parallel (big_pts, lower, upper, 
+                                                &my_batch_integrand, NULL, 0);
+  cout << setprecision(6) << scientific
+       << "Milne with N = " << big_pts << ": relative error "
+       << fabs ((serial_result - answer)/answer) << " (serial), "
+       << fabs ((parallel_result - answer)/answer) << " (parallel)" << endl;
   
 	   
 	  
@@ -130,3 +271,26 @@ my_gsl_integrand (double x, void *)
 {
 	return (exp (-x*x));
 }
+
+// the same function, evaluated at a block of points at once
+void
+my_batch_integrand (int n, const double x[], double f[], void *)
+{
+  for (int i = 0; i < n; i++)
+  {
+    f[i] = exp (-x[i]*x[i]);
+  }
+}
+
+// the product of the same function in each of *params dimensions
+double
+my_mc_integrand (const double x[], void *params)
+{
+  int dim = *(int *) params;
+  double r_sq = 0.;
+  for (int d = 0; d < dim; d++)
+  {
+    r_sq += x[d]*x[d];
+  }
+  return (exp (-r_sq));
+}
@@ -0,0 +1,240 @@
+//  file: monte_carlo.cpp
+//
+//  Monte Carlo (MC) and quasi-Monte Carlo (QMC) integration in d
+//   dimensions, split over threads.
+//
+//  Revision history:
+//      17-Oct-2026  original version
+//      17-Oct-2026  the first round runs even if max_samples is smaller
+//
+//  Notes:
+//   * Random numbers come from a counter-based generator: the number
+//      for (seed, stream, counter) is a hash of those three integers
+//      (the SplitMix64 mixing function).  No generator state is shared
+//      or passed between threads, and sample i is the same no matter
+//      which thread computes it.
+//   * The points are handled in batches of a fixed size.  Each batch
+//      is summed into its own slot and the slots are added in order, so
+//      the result doesn't depend on the number of threads.
+//   * MC_PLAIN: error = standard deviation of f / sqrt(N).
+//     MC_HALTON: Halton points (radical inverses in the first dim
+//      primes), shifted modulo 1 by a random vector.  num_shifts
+//      independent shifts give independent estimates, and their spread
+//      is the error estimate.  The error falls off nearly like 1/N
+//      instead of 1/sqrt(N) for smooth integrands.
+//   * compile with:  "g++ -Wall -c monte_carlo.cpp" or makefile
+//
+//************************************************************************
+
+// include files
+#include <cmath>
+#include <vector>
+#include <thread>
+#include <atomic>
+using namespace std;
+
+#include "monte_carlo.h"   // prototypes
+
+// local definitions and helper functions
+const long batch_size = 4096;       // # of points per task
+const long first_samples = 16384;   // # of points in the first round
+const int num_shifts = 8;           // # of random shifts for MC_HALTON
+
+static const int primes[mc_max_dim] = {
+  2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53,
+  59, 61, 67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131
+};
+
+typedef struct                      // sums over one batch of points
+{
+  double sum;
+  double sum_sq;
+}
+batch_sums;
+
+static double counter_uniform (unsigned long seed, unsigned long stream,
+                               unsigned long counter);
+static double radical_inverse (unsigned long index, int base);
+
+//************************************************************************
+
+// Integral of f over a box by MC or QMC, doubling the number of points
+//  each round until the error estimate is small enough
+int mc_integrate (mc_integrand_t f, void *params, int dim,
+                  const double lower[], const double upper[], int method,
+                  double abs_error, double rel_error, long max_samples,
+                  unsigned long seed, int num_threads, double *result_ptr,
+                  double *error_ptr, long *num_samples_ptr)
+{
+   if (method == MC_HALTON && dim > mc_max_dim)
+   {
+     method = MC_PLAIN;             // not enough primes for Halton
+   }
+   if (num_threads <= 0)
+   {
+     num_threads = int (thread::hardware_concurrency ());
+   }
+   if (num_threads < 1) num_threads = 1;
+
+   double volume = 1.;
+   for (int d=0; d<dim; d++)
+   {
+     volume *= upper[d] - lower[d];
+   }
+
+   // the random shifts for MC_HALTON (stream 0 of the generator)
+   int num_estimates = (method == MC_HALTON) ? num_shifts : 1;
+   vector<double> shifts (num_estimates * dim);
+   for (size_t k=0; k<shifts.size (); k++)
+   {
+     shifts[k] = counter_uniform (seed, 0, k);
+   }
+
+   vector<batch_sums> totals (num_estimates);   // over all rounds
+   for (int e=0; e<num_estimates; e++)
+   {
+     totals[e].sum = 0.;
+     totals[e].sum_sq = 0.;
+   }
+
+   long num_done = 0;                // points done (per estimate); the
+                                     //  total is num_done*num_estimates
+   long num_new = first_samples;     // points in this round
+   double result = 0., error = 0.;
+   int status = 1;
+
+   // the first round always runs (even past max_samples), so there is
+   //  an estimate and an error to return
+   while (num_done == 0
+          || (num_done + num_new) * num_estimates <= max_samples)
+   {
+     long num_batches = (num_new + batch_size - 1) / batch_size;
+     long num_tasks = num_batches * num_estimates;
+     vector<batch_sums> task_sums (num_tasks);
+     atomic<long> next_task (0);
+
+     // each worker takes the next (estimate, batch) until none are left
+     auto worker = [&] ()
+     {
+       vector<double> x (dim);
+       long task;
+       while ((task = next_task++) < num_tasks)
+       {
+         int estimate = task / num_batches;
+         long first = num_done + (task % num_batches) * batch_size;
+         long last = first + batch_size;
+         if (last > num_done + num_new) last = num_done + num_new;
+
+         double sum = 0., sum_sq = 0.;
+         for (long i=first; i<last; i++)
+         {
+           for (int d=0; d<dim; d++)
+           {
+             double u;
+             if (method == MC_HALTON)
+             {
+               u = radical_inverse (i + 1, primes[d])
+                     + shifts[estimate*dim + d];
+               u -= floor (u);
+             }
+             else                  // stream 1 for the points
+             {
+               u = counter_uniform (seed, 1, i*dim + d);
+             }
+             x[d] = lower[d] + (upper[d] - lower[d]) * u;
+           }
+           double value = f (x.data (), params);
+           sum += value;
+           sum_sq += value * value;
+         }
+         task_sums[task].sum = sum;
+         task_sums[task].sum_sq = sum_sq;
+       }
+     };
+
+     vector<thread> threads;
+     for (int t=1; t<num_threads && t<num_tasks; t++)
+     {
+       threads.push_back (thread (worker));
+     }
+     worker ();                      // this thread works too
+     for (size_t t=0; t<threads.size (); t++)
+     {
+       threads[t].join ();
+     }
+
+     for (long task=0; task<num_tasks; task++)   // add up in order
+     {
+       int estimate = task / num_batches;
+       totals[estimate].sum += task_sums[task].sum;
+       totals[estimate].sum_sq += task_sums[task].sum_sq;
+     }
+     num_done += num_new;
+     num_new = num_done;             // double the total next round
+
+     if (method == MC_HALTON)        // spread of the shifted estimates
+     {
+       double mean = 0., spread = 0.;
+       for (int e=0; e<num_estimates; e++)
+       {
+         mean += totals[e].sum / num_done;
+       }
+       mean /= num_estimates;
+       for (int e=0; e<num_estimates; e++)
+       {
+         double diff = totals[e].sum / num_done - mean;
+         spread += diff * diff;
+       }
+       result = volume * mean;
+       error = volume * sqrt (spread / (num_estimates * (num_estimates-1.)));
+     }
+     else                            // standard deviation / sqrt(N)
+     {
+       double mean = totals[0].sum / num_done;
+       double variance = totals[0].sum_sq / num_done - mean * mean;
+       result = volume * mean;
+       error = volume * sqrt (fmax (variance, 0.) / num_done);
+     }
+
+     if (error <= fmax (abs_error, rel_error * fabs (result)))
+     {
+       status = 0;
+       break;
+     }
+   }
+
+   *result_ptr = result;
+   *error_ptr = error;
+   *num_samples_ptr = num_done * num_estimates;
+   return (status);
+}
+
+//************************************************************************
+
+// Uniform number in [0,1) from (seed, stream, counter): SplitMix64 hash
+static double counter_uniform (unsigned long seed, unsigned long stream,
+                               unsigned long counter)
+{
+   unsigned long long z = (unsigned long long) seed
+                            * 0x9E3779B97F4A7C15ULL;
+   z ^= ((unsigned long long) stream + 1) * 0xD1B54A32D192ED03ULL;
+   z += (unsigned long long) counter * 0x9E3779B97F4A7C15ULL;
+   z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+   z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+   z ^= z >> 31;
+   return ((z >> 11) * (1.0 / 9007199254740992.0));   // top 53 bits
+}
+
+// Radical inverse of index in base: the digits mirrored about the point
+static double radical_inverse (unsigned long index, int base)
+{
+   double inverse = 0.;
+   double factor = 1. / base;
+   while (index > 0)
+   {
+     inverse += factor * (index % base);
+     index /= base;
+     factor /= base;
+   }
+   return (inverse);
+}
@@ -0,0 +1,46 @@
+//  file: monte_carlo.h
+//
+//  Header file for monte_carlo.cpp: multi-threaded Monte Carlo and
+//   quasi-Monte Carlo integration over a box in d dimensions.
+//
+//  Revision History:
+//    17-Oct-2026 --- original version
+//
+//  Notes:
+//   * The integrand is called from several threads at once, so it
+//      must be thread safe (no static or global scratch variables).
+//   * Results depend only on the seed, not on the number of threads.
+//
+//************************************************************************
+
+#ifndef MONTE_CARLO_H
+#define MONTE_CARLO_H
+
+//  integrand f(x, params) with x[0],...,x[dim-1]
+typedef double (*mc_integrand_t) (const double x[], void *params);
+
+//  sampling methods
+const int MC_PLAIN = 1;         // pseudo-random points
+const int MC_HALTON = 2;        // randomly shifted Halton points (QMC)
+
+const int mc_max_dim = 32;      // largest dimension for MC_HALTON
+
+//  begin: function prototypes
+
+                  // integral of f over lower[d] <= x[d] <= upper[d]; the
+                  //  number of points doubles until the error estimate is
+                  //  below abs_error or rel_error (returns 0) or more than
+                  //  max_samples points would be needed (returns 1).  The
+                  //  first round (16384 points, times 8 for MC_HALTON) is
+                  //  always done, so there is always an error estimate.
+                  //  num_threads <= 0 means use all cores.
+extern int mc_integrate (mc_integrand_t f, void *params, int dim,
+                         const double lower[], const double upper[],
+                         int method, double abs_error, double rel_error,
+                         long max_samples, unsigned long seed,
+                         int num_threads, double *result_ptr,
+                         double *error_ptr, long *num_samples_ptr);
+
+//  end: function prototypes
+
+#endif
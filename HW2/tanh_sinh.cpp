@@ -0,0 +1,326 @@
+//  file: tanh_sinh.cpp
+//
+//  Double-exponential (DE) integration.  A change of variables x(t)
+//   makes the integrand decay double exponentially in t, and then the
+//   trapezoid rule in t converges very fast:
+//    * tanh-sinh on [a,b]:  x = (a+b)/2 + (b-a)/2 tanh(pi/2 sinh t)
+//    * exp-sinh on [a,inf): x = a + exp(pi/2 sinh t)
+//
+//  Revision history:
+//      17-Oct-2026  original version
+//      17-Oct-2026  vector-valued integrands: many functions integrated
+//                    with one set of points
+//      17-Oct-2026  abs_error for the scalar versions too (an integral
+//                    near 0 never meets a relative error)
+//
+//  Notes:
+//   * The trapezoid points in t are computed once for every level
+//      (step h = 1/2^level) and saved.  Each level adds only the new
+//      midpoints, so all earlier function values are reused, and the
+//      difference between the last two levels is the error estimate.
+//   * Near the endpoints the distance to the endpoint is computed
+//      directly (1 - tanh(u) = 2/(exp(2u)+1)), so there is no
+//      cancellation and singular endpoints are handled.  The points can
+//      only get as close to an endpoint as floating point resolves, so
+//      put a singular endpoint at x = 0 (shift the variable) for best
+//      accuracy.
+//   * Level 0 finds where the terms become negligible on each side;
+//      the finer levels don't go past those points.
+//   * A vector integrand fills all of its components at each x, so 
+//      work shared between the components is done once per point.  The
+//      refinement stops when every component has converged, and each 
+//      component gets its own error estimate.
+//   * compile with:  "g++ -Wall -c tanh_sinh.cpp" or makefile
+//
+//************************************************************************
+
+// include files
+#include <cmath>
+#include <vector>
+using namespace std;
+
+#include "tanh_sinh.h"   // prototypes
+
+// local definitions and helper functions
+const int max_level = 10;        // finest step is h = 1/2^max_level
+const double t_max = 6.;         // largest t (exp(pi/2 sinh t) ~ 1e137)
+const double negligible = 1.e-20;   // relative size of a dropped term
+
+typedef struct                   // one trapezoid point t > 0 (or t = 0)
+{
+  double t;
+  double cosh_factor;            // pi/2 cosh(t)
+  double exp_u;                  // exp(u) with u = pi/2 sinh(t)
+}
+ts_node;
+
+typedef struct                   // the new points at each level
+{
+  vector<ts_node> level[max_level+1];
+}
+ts_table;
+
+typedef struct                   // x and weight for one point
+{
+  double x;
+  double weight;
+}
+ts_point;
+
+static const ts_table &node_table ();
+typedef struct                   // a scalar integrand and its parameters
+{
+  ts_integrand_t f;
+  void *params;
+}
+scalar_parameters;
+
+static int de_integrate (int mapping, ts_vector_integrand_t f,
+                         int num_components, void *params, double a,
+                         double b, double abs_error, double rel_error,
+                         double results[], double errors[],
+                         long *num_evals_ptr);
+static void scalar_component (double x, double f[], void *params);
+static void map_node (int mapping, const ts_node &node, double a, double b,
+                      ts_point *minus_ptr, ts_point *plus_ptr);
+
+const int TANH_SINH = 0;         // mappings for de_integrate
+const int EXP_SINH = 1;
+
+//************************************************************************
+
+// Integral of f from a to b with the tanh-sinh rule
+int ts_integrate (ts_integrand_t f, void *params, double a, double b,
+                  double abs_error, double rel_error, double *result_ptr,
+                  double *error_ptr, long *num_evals_ptr)
+{
+   scalar_parameters scalar_params = { f, params };
+   return (de_integrate (TANH_SINH, &scalar_component, 1, &scalar_params,
+                         a, b, abs_error, rel_error, result_ptr, error_ptr,
+                         num_evals_ptr));
+}
+
+// Integral of f from a to infinity with the exp-sinh rule
+int ts_integrate_upper (ts_integrand_t f, void *params, double a,
+                        double abs_error, double rel_error,
+                        double *result_ptr, double *error_ptr,
+                        long *num_evals_ptr)
+{
+   scalar_parameters scalar_params = { f, params };
+   return (de_integrate (EXP_SINH, &scalar_component, 1, &scalar_params,
+                         a, 0., abs_error, rel_error, result_ptr, error_ptr,
+                         num_evals_ptr));
+}
+
+// Integrals of all num_components components of f from a to b
+int ts_integrate_multi (ts_vector_integrand_t f, int num_components,
+                        void *params, double a, double b, double abs_error,
+                        double rel_error, double results[], double errors[],
+                        long *num_evals_ptr)
+{
+   return (de_integrate (TANH_SINH, f, num_components, params, a, b,
+                         abs_error, rel_error, results, errors,
+                         num_evals_ptr));
+}
+
+// Integrals of all num_components components of f from a to infinity
+int ts_integrate_upper_multi (ts_vector_integrand_t f, int num_components,
+                              void *params, double a, double abs_error,
+                              double rel_error, double results[],
+                              double errors[], long *num_evals_ptr)
+{
+   return (de_integrate (EXP_SINH, f, num_components, params, a, 0.,
+                         abs_error, rel_error, results, errors,
+                         num_evals_ptr));
+}
+
+// Vector integrand made from a list of scalar integrands
+void ts_list_integrand (double x, double f[], void *params)
+{
+   ts_integrand_list *list_ptr = (ts_integrand_list *) params;
+   for (int c=0; c<list_ptr->num_functions; c++)
+   {
+     f[c] = list_ptr->functions[c] (x, list_ptr->params[c]);
+   }
+}
+
+//************************************************************************
+
+// Trapezoid rule in t for all components of f at once, refined by 
+//  halving h until the estimates from two successive levels agree to 
+//  abs_error or rel_error for every component
+static int de_integrate (int mapping, ts_vector_integrand_t f,
+                         int num_components, void *params, double a,
+                         double b, double abs_error, double rel_error,
+                         double results[], double errors[],
+                         long *num_evals_ptr)
+{
+   const ts_table &table = node_table ();
+   long num_evals = 0;
+   vector<double> sums (num_components, 0.);  // weight*f over all levels
+   vector<double> values (num_components);    // f at the current point
+
+   // add weight*f at one point to the sums; returns the largest term 
+   auto add_point = [&] (const ts_point &point)
+   {
+     f (point.x, values.data (), params);
+     num_evals++;
+     double largest = 0.;
+     for (int c=0; c<num_components; c++)
+     {
+       double term = point.weight * values[c];
+       sums[c] += term;
+       largest = fmax (largest, fabs (term));
+     }
+     return (largest);
+   };
+   auto largest_sum = [&] ()
+   {
+     double largest = 0.;
+     for (int c=0; c<num_components; c++)
+     {
+       largest = fmax (largest, fabs (sums[c]));
+     }
+     return (largest);
+   };
+
+   double t_cut_minus = t_max;        // cutoffs found at level 0
+   double t_cut_plus = t_max;
+   int minus_small = 0, plus_small = 0;   // # of negligible terms in a row
+
+   // level 0 (h = 1): also find where the terms become negligible 
+   //  (two in a row, so an accidental zero of f doesn't stop it)
+   for (size_t k=0; k<table.level[0].size (); k++)
+   {
+     const ts_node &node = table.level[0][k];
+     ts_point minus, plus;
+     map_node (mapping, node, a, b, &minus, &plus);
+     if (node.t == 0.)                // center point counted once
+     {
+       add_point (plus);
+       continue;
+     }
+     if (minus_small < 2)
+     {
+       double term = (minus.weight > 0.) ? add_point (minus) : 0.;
+       minus_small = (term <= negligible * largest_sum ())
+                       ? minus_small + 1 : 0;
+       t_cut_minus = node.t;
+     }
+     if (plus_small < 2)
+     {
+       double term = (plus.weight > 0.) ? add_point (plus) : 0.;
+       plus_small = (term <= negligible * largest_sum ())
+                      ? plus_small + 1 : 0;
+       t_cut_plus = node.t;
+     }
+   }
+
+   double h = 1.;
+   for (int c=0; c<num_components; c++)
+   {
+     results[c] = h * sums[c];
+     errors[c] = fabs (results[c]);
+   }
+   int status = 1;
+
+   for (int level=1; level<=max_level; level++)   // add the midpoints
+   {
+     for (size_t k=0; k<table.level[level].size (); k++)
+     {
+       const ts_node &node = table.level[level][k];
+       ts_point minus, plus;
+       map_node (mapping, node, a, b, &minus, &plus);
+       if (node.t < t_cut_minus && minus.weight > 0.)
+       {
+         add_point (minus);
+       }
+       if (node.t < t_cut_plus && plus.weight > 0.)
+       {
+         add_point (plus);
+       }
+     }
+     h *= 0.5;
+     bool converged = (level > 1);
+     for (int c=0; c<num_components; c++)
+     {
+       double new_result = h * sums[c];
+       errors[c] = fabs (new_result - results[c]);
+       results[c] = new_result;
+       if (errors[c] > fmax (abs_error, rel_error * fabs (new_result)))
+       {
+         converged = false;
+       }
+     }
+     if (converged)
+     {
+       status = 0;
+       break;
+     }
+   }
+
+   *num_evals_ptr = num_evals;
+   return (status);
+}
+
+// A scalar integrand as a vector integrand with one component
+static void scalar_component (double x, double f[], void *params)
+{
+   scalar_parameters *scalar_ptr = (scalar_parameters *) params;
+   f[0] = scalar_ptr->f (x, scalar_ptr->params);
+}
+
+// x and weight (dx/dt) for the points at -t and +t.  A point that
+//  lands on the endpoint in floating point gets weight zero (skipped).
+static void map_node (int mapping, const ts_node &node, double a, double b,
+                      ts_point *minus_ptr, ts_point *plus_ptr)
+{
+   double e = node.exp_u;
+   if (mapping == TANH_SINH)
+   {
+     double half_width = 0.5 * (b - a);
+     double cosh_u = 0.5 * (e + 1./e);
+     double distance = 2. / (e*e + 1.);    // 1 - tanh(u), no cancellation
+     double weight = half_width * node.cosh_factor / (cosh_u * cosh_u);
+     minus_ptr->x = a + half_width * distance;
+     plus_ptr->x = b - half_width * distance;
+     minus_ptr->weight = (minus_ptr->x > a && minus_ptr->x < b) ? weight : 0.;
+     plus_ptr->weight = (plus_ptr->x > a && plus_ptr->x < b) ? weight : 0.;
+   }
+   else                                     // EXP_SINH
+   {
+     minus_ptr->x = a + 1./e;               // sinh(-t) = -sinh(t)
+     plus_ptr->x = a + e;
+     minus_ptr->weight = (minus_ptr->x > a) ? node.cosh_factor / e : 0.;
+     plus_ptr->weight = node.cosh_factor * e;
+   }
+}
+
+//************************************************************************
+
+// The points t >= 0 for every level, computed on the first call only:
+//  level 0 has t = 0,1,2,...; level m has the odd multiples of 1/2^m
+static const ts_table &node_table ()
+{
+   static const ts_table table = [] ()
+   {
+     const double pi = 3.14159265358979323846;
+     ts_table new_table;
+     for (int level=0; level<=max_level; level++)
+     {
+       double h = ldexp (1., -level);
+       int start = (level == 0) ? 0 : 1;
+       int step = (level == 0) ? 1 : 2;
+       for (int k=start; k*h<=t_max; k+=step)
+       {
+         ts_node node;
+         node.t = k*h;
+         node.cosh_factor = 0.5 * pi * cosh (node.t);
+         node.exp_u = exp (0.5 * pi * sinh (node.t));
+         new_table.level[level].push_back (node);
+       }
+     }
+     return (new_table);
+   } ();
+   return (table);
+}
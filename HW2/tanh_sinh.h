@@ -0,0 +1,67 @@
+//  file: tanh_sinh.h
+//
+//  Header file for tanh_sinh.cpp: double-exponential integration
+//   (tanh-sinh on [a,b] and exp-sinh on [a,infinity)).
+//
+//  Revision History:
+//    17-Oct-2026 --- original version
+//    17-Oct-2026 --- added vector-valued integrands (many integrals at once)
+//    17-Oct-2026 --- abs_error for ts_integrate and ts_integrate_upper
+//
+//  Notes:
+//   * The integrand has the same form as for a gsl_function.
+//   * The integrand is never evaluated at a or b, so integrable
+//      singularities at the endpoints (like 1/sqrt(x) at 0) are ok.
+//
+//************************************************************************
+
+#ifndef TANH_SINH_H
+#define TANH_SINH_H
+
+//  integrand f(x, params)
+typedef double (*ts_integrand_t) (double x, void *params);
+
+//  vector integrand: fill f[c] for c = 0,...,num_components-1 at x
+typedef void (*ts_vector_integrand_t) (double x, double f[], void *params);
+
+typedef struct                  // a list of scalar integrands to be used
+{                               //  as one vector integrand (params for
+  int num_functions;            //  ts_list_integrand)
+  ts_integrand_t *functions;
+  void **params;
+}
+ts_integrand_list;
+
+//  begin: function prototypes
+
+                  // integral of f from a to b (tanh-sinh); returns 0 if the
+                  //  error is below abs_error or rel_error |result|, 1 if
+                  //  not (after all levels)
+extern int ts_integrate (ts_integrand_t f, void *params, double a, double b,
+                         double abs_error, double rel_error,
+                         double *result_ptr, double *error_ptr,
+                         long *num_evals_ptr);
+                  // integral of f from a to infinity (exp-sinh)
+extern int ts_integrate_upper (ts_integrand_t f, void *params, double a,
+                               double abs_error, double rel_error,
+                               double *result_ptr, double *error_ptr,
+                               long *num_evals_ptr);
+
+                  // integrals of every component of f over one shared set
+                  //  of points, with an error estimate for each; converged
+                  //  when every error is below abs_error or rel_error
+extern int ts_integrate_multi (ts_vector_integrand_t f, int num_components,
+                               void *params, double a, double b,
+                               double abs_error, double rel_error,
+                               double results[], double errors[],
+                               long *num_evals_ptr);
+extern int ts_integrate_upper_multi (ts_vector_integrand_t f,
+                                     int num_components, void *params,
+                                     double a, double abs_error,
+                                     double rel_error, double results[],
+                                     double errors[], long *num_evals_ptr);
+extern void ts_list_integrand (double x, double f[], void *params);
+
+//  end: function prototypes
+
+#endif
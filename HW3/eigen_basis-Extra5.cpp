@@ -16,6 +16,10 @@
 //      04/26/19  Devised a measure for how close the approximate is, defined by the chisquare value. From fitting a line to
 //                a log-log plot of the dimension size to the chisquared error, this line had a slope of about -1. Therefore,
 //                the error scales with dimension size like N^-1.
+//      10/17/26  The basis grows by one state per step: only the new row and column of H are
+//                integrated, and the ground state comes from LOBPCG (lobpcg.cpp) started from the
+//                previous ground state.  Optional early stop (-Etol, -chitol) when E0 or chisquared
+//                changes by less than the tolerance twice in a row.
 //
 //  Notes:
 //   * Based on the documentation for the GSL library under
@@ -38,6 +42,15 @@
 //   * We use gls_integration_qagiu for the integrals from
 //      0 to Infinity (calculating matrix elements of H).
 //   * Start with l=0 (and generalize later)
+//   * Only the ground state is needed for chisquared, so instead of 
+//      diagonalizing all of H at every dimension, lowest_eigenpair
+//      (LOBPCG) finds it from the ground state of the last dimension 
+//      with a zero added (8-12 iterations per dimension for Coulomb,
+//      dimensions 4 to 19, with the band preconditioner in lobpcg.cpp).
+//   * E0 comes down in pairs of dimensions for Coulomb (dimensions 5 and
+//      6 give nearly the same E0, then 7 is much lower), so one small
+//      change doesn't mean much.  The early stop (-Etol, -chitol) needs
+//      the change to be below the tolerance for two steps in a row.
 //
 //  To do:
 //   * Add the Morse potential (function is given but not incorporated)
@@ -59,10 +72,14 @@
 #include <iomanip>		// note that .h is omitted
 #include <cmath>
 #include <fstream>		// note that .h is omitted
+#include <vector>
+#include <cstring>
+#include <cstdlib>
 using namespace std;
 
 #include <gsl/gsl_eigen.h>	        // gsl eigensystem routines
 #include <gsl/gsl_integration.h>	// gsl integration routines
+#include "lobpcg.h"		// lowest eigenpair from a starting vector 
 
 // structures and function prototypes 
 typedef struct			// structure holding Hij parameters 
@@ -89,7 +106,7 @@ double V_square_well (double r, potential_parameters * potl_params_ptr);
 double V_morse (double r, potential_parameters * potl_params_ptr);
 
 // i'th-j'th matrix element of Hamiltonian in ho basis 
-double Hij (hij_parameters ho_parameters);
+double Hij (hij_parameters ho_parameters, gsl_integration_workspace * work);
 double Hij_integrand (double x, void *params_ptr);
 
 // harmonic oscillator routines from harmonic_oscillator.cpp 
@@ -101,10 +118,34 @@ inline double sqr (double x)  {return x*x;}
 
 //************************** main program ***************************
 int
-main ()
+main (int argc, char *argv[])
 {
   hij_parameters ho_parameters;  // parameters for the Hamiltonian
 
+  // options on the command line (tolerances of 0 mean run to MaxD) 
+  double E_tolerance = 0.;	// stop when E0 changes by less 
+  double chisq_tolerance = 0.;	// stop when chisquared changes by less 
+  for (int arg = 1; arg < argc; arg++)	//  (relative) 
+    {
+      if (strcmp (argv[arg], "-Etol") == 0 && arg + 1 < argc)
+	{
+	  E_tolerance = atof (argv[++arg]);
+	}
+      else if (strcmp (argv[arg], "-chitol") == 0 && arg + 1 < argc)
+	{
+	  chisq_tolerance = atof (argv[++arg]);
+	}
+      else
+	{
+	  cout << "usage: " << argv[0] << " [-Etol dE] [-chitol dchi]" << endl
+	       << "  -Etol dE      stop when the ground-state energy changes"
+	       << " by less than dE (twice in a row)" << endl
+	       << "  -chitol dchi  stop when chisquared changes by less than"
+	       << " dchi (relative, twice in a row)" << endl;
+	  return (1);
+	}
+    }
+
   // pick the potential based on the integer "answer" 
   int answer = 0;
   while (answer != 1 && answer != 2)	// don't quit until 1 or 2!
@@ -125,89 +166,101 @@ main ()
   double MaxD = 20;       // ending dimension value.
   ofstream out ("EC#5b1D1");	// open the output file 
   out << "dimension" << " " << "chisquared" << endl;
-  
-  // pick the dimension of the basis (matrix) 
+
+  // The basis grows one state at a time.  H is allocated for the 
+  //  largest dimension and the top-left dimension x dimension block
+  //  is used; each step only adds the new row and column.  The ground 
+  //  state for the last dimension (plus a zero) starts the eigensolver.
+  int max_dimension = int (MaxD);
+  gsl_matrix *Hmat_ptr = gsl_matrix_alloc (max_dimension, max_dimension); 
+  vector<double> ground_state (max_dimension, 0.);	// eigenvector 
+  ground_state[0] = 1.;		// start for dimension 1 
+  gsl_integration_workspace *integ_work = gsl_integration_workspace_alloc (1000);
+  const double eigen_tolerance = 1.e-10;	// on |H x - E x| 
+  const int max_iter = 1000;	// LOBPCG iterations per dimension 
+  double E_last = 0., chisq_last = 0.;	// for the early stop 
+  int num_settled = 0;		// steps in a row below the tolerance 
+
   int dimension = 1;		// dimension of the matrices and vectors 
   while (dimension < MaxD) //initialize loop over dimensions.
-  {
-  double chisquared=0;    // initialize chisquared
-  // See the GSL documentation for matrix, vector structures 
-  //  Define and allocate space for the vectors, matrices, and workspace 
-                               // original gsl matrix with Hamiltonian 
-  gsl_matrix *Hmat_ptr = gsl_matrix_alloc (dimension, dimension); 
-                               // gsl vector with eigenvalues 
-  gsl_vector *Eigval_ptr = gsl_vector_alloc (dimension);	
-                               // gsl matrix with eigenvectors 
-  gsl_matrix *Eigvec_ptr = gsl_matrix_alloc (dimension, dimension);	
-                               // the workspace for gsl 
-  gsl_eigen_symmv_workspace *worksp= gsl_eigen_symmv_alloc (dimension);	
-
-  // Load the Hamiltonian matrix pointed to by Hmat_ptr 
-  for (int i = 0; i < dimension; i++)
     {
-      for (int j = 0; j < dimension; j++)
+      double chisquared=0;    // initialize chisquared
+      int j = dimension - 1;	// the new basis state 
+
+      // the new column (and row) of the Hamiltonian matrix 
+      for (int i = 0; i <= j; i++)
 	{
 	  ho_parameters.i = i;
 	  ho_parameters.j = j;
-	  gsl_matrix_set (Hmat_ptr, i, j, Hij (ho_parameters));
+	  double Hij_value = Hij (ho_parameters, integ_work);
+	  gsl_matrix_set (Hmat_ptr, i, j, Hij_value);
+	  gsl_matrix_set (Hmat_ptr, j, i, Hij_value);
 	  // print statement for debugging 
 	  cout << "i = " << i << ", j = " << j
-	    << ", Hij = " << Hij (ho_parameters) << endl;
+	    << ", Hij = " << Hij_value << endl;
 	}
-    }
 
-  // Find the eigenvalues and eigenvectors of the real, symmetric
-  //  matrix pointed to by Hmat_ptr.  It is partially destroyed
-  //  in the process. The eigenvectors are pointed to by 
-  //  Eigvec_ptr and the eigenvalues by Eigval_ptr.
-  gsl_eigen_symmv (Hmat_ptr, Eigval_ptr, Eigvec_ptr, worksp);
-
-  // Sort the eigenvalues and eigenvectors in ascending order 
-  gsl_eigen_symmv_sort (Eigval_ptr, Eigvec_ptr, GSL_EIGEN_SORT_VAL_ASC);
-
-  // Print out the results   
-  // Allocate a pointer to one of the eigenvectors of the matrix 
-  gsl_vector *eigenvector_ptr = gsl_vector_alloc (dimension);	
-  double r = 0.1;
-  double rend = 10;
-  double dr = .1;
-  //for (int i = 0; i < dimension; i++)
-    //{
-      //double eigenvalue = gsl_vector_get (Eigval_ptr, 0);
-      gsl_matrix_get_col (eigenvector_ptr, Eigvec_ptr, 0);
-
-      //cout << "eigenvalue " << i+1 << " = " 
-           //<< scientific << eigenvalue << endl;
-
-      // Don't print the eigenvectors yet . . .
-       //cout << "eigenvector = " << endl;
-	   while (r < rend)
-	   {
-		   double sum=0;
-
-       for (int j = 0; j < dimension; j++)
-       {
-		 sum+=gsl_vector_get (eigenvector_ptr, j) * ho_radial (j+1, 0, b_ho,r);
-         //cout << scientific << gsl_vector_get (eigenvector_ptr, j) << endl;
-	   }
-	   chisquared+=((sum - 2.*r*exp(-r))*(sum - 2.*r*exp(-r)))/(2.*r*exp(-r));
-	   
-	   r+=dr;
+      // ground state of the dimension x dimension block 
+      gsl_matrix_view H_view = gsl_matrix_submatrix (Hmat_ptr, 0, 0,
+						     dimension, dimension);
+      gsl_vector_view x_view = gsl_vector_view_array (ground_state.data (),
+						      dimension);
+      double eigenvalue;
+      int num_iter;
+      lowest_eigenpair (&H_view.matrix, &x_view.vector, eigen_tolerance,
+			max_iter, &eigenvalue, &num_iter);
+      if (ground_state[0] < 0.)	// same sign convention every time 
+	{
+	  for (int n = 0; n < dimension; n++)
+	    {
+	      ground_state[n] = -ground_state[n];
+	    }
+	}
+      cout << "dimension " << dimension << ": E0 = " << eigenvalue
+	<< " (" << num_iter << " iterations)" << endl;
+
+      double r = 0.1;
+      double rend = 10;
+      double dr = .1;
+      while (r < rend)
+	{
+	  double sum=0;
+	  for (int n = 0; n < dimension; n++)
+	    {
+	      sum+=ground_state[n] * ho_radial (n+1, 0, b_ho,r);
+	    }
+	  chisquared+=((sum - 2.*r*exp(-r))*(sum - 2.*r*exp(-r)))/(2.*r*exp(-r));
+	  r+=dr;
+	}
+      out << log(dimension) << " " << log(chisquared) << endl;
+
+      // stop early if E0 or chisquared has settled down (two steps 
+      //  in a row) 
+      if (dimension > 1 && ((E_tolerance > 0. 
+			     && fabs (eigenvalue - E_last) < E_tolerance)
+			    || (chisq_tolerance > 0.
+				&& fabs (chisquared - chisq_last)
+				< chisq_tolerance * chisq_last)))
+	{
+	  num_settled++;
+	}
+      else
+	{
+	  num_settled = 0;
+	}
+      if (num_settled >= 2)
+	{
+	  cout << "converged at dimension " << dimension << endl;
+	  break;
+	}
+      E_last = eigenvalue;
+      chisq_last = chisquared;
+      dimension+=1;
     }
-	out << log(dimension) << " " << log(chisquared) << endl;
-    
-	
-	
-	
-	
-  // free the space used by the vector and matrices  and workspace 
-  gsl_matrix_free (Eigvec_ptr);
-  gsl_vector_free (Eigval_ptr);
+
+  // free the space used by the matrix and workspace 
   gsl_matrix_free (Hmat_ptr);
-  gsl_vector_free (eigenvector_ptr);
-  gsl_eigen_symmv_free (worksp);
-  dimension+=1;
-	}
+  gsl_integration_workspace_free (integ_work);
   out.close ();
   return (0);			// successful completion 
 }
@@ -224,11 +277,13 @@ main ()
 //
 // Take l=0 only for now 
 //
+// work must have room for 1000 intervals; it is reused from call to
+//  call
+//
 //*************************************************************
 double
-Hij (hij_parameters ho_parameters)
+Hij (hij_parameters ho_parameters, gsl_integration_workspace * work)
 {
-  gsl_integration_workspace *work = gsl_integration_workspace_alloc (1000);
   gsl_function F_integrand;
 
   double lower_limit = 0.;	// start integral from 0 (to infinity) 
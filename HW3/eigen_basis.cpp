@@ -14,6 +14,42 @@
 //                b and basis dimension size. The code was then used to generate wave functions for b=2,3 and for each,
 //                dimension sizes 1,5,10, and 20.
 //      04/26/19  Devised a measure for how close the approximate is, defined by the chisquare value 
+//      10/17/26  Added -sweep option: all matrix elements from one tanh-sinh integration over a shared
+//                set of points (Hij_sweep), with an error estimate for each element
+//      10/17/26  Only the upper triangle of H is integrated (and mirrored); the debugging output
+//                prints the stored values instead of integrating again.  Added -symcheck option.
+//      10/17/26  Hij reuses a workspace passed to it (it used to allocate one per call and never
+//                free it).  Added -threads option: tiles of H spread over a work-stealing pool.
+//      10/17/26  Added -table option: basis tabulated once on a Gauss-Legendre grid and
+//                H = Phi^T D Phi + diag(E_n) with one matrix multiplication (Hij_tabulated)
+//      10/17/26  Added -analytic option: closed-form Coulomb and kinetic matrix elements
+//                (Hij_analytic), no integration at all
+//      10/17/26  Added -lowest k and -start options: only the k lowest eigenpairs, by LOBPCG
+//                (lobpcg.cpp), optionally from a starting vector read from a file
+//      10/17/26  Wavefunctions for all requested states from one matrix product on the r grid
+//                (reconstruct_wavefunctions); chisquared and other error norms in one loop.
+//                Added -states m and -dr h options.
+//      10/17/26  The basis is tabulated with ho_radial_family (ho_family.cpp), all n at once
+//                from the Laguerre recurrence, in -sweep, -table and the wavefunction output
+//      10/17/26  Potential registry: potentials are picked by name (Coulomb, square well, Morse,
+//                Gaussian) with their parameters read in, and each one has its own Hij integrand
+//                (a template on the potential function) with no switch in it
+//      10/17/26  Any l (-l option), and -lmax option: the l = 0,...,l_max blocks of H built and
+//                diagonalized at the same time on several threads, with one combined spectrum
+//                labeled by (n,l) (solve_partial_waves)
+//      10/17/26  Added -optimize option: the b that minimizes the ground-state energy, from a
+//                scan on several threads and then Brent's method (optimize_b), with the basis
+//                tabulated once for b = 1 and rescaled (Hij_scaled)
+//      10/17/26  Added -cache option: integrated matrix elements and their error estimates
+//                are kept in a memory-mapped file (hij_cache.cpp) and reused by later runs
+//      10/17/26  Added -batch option: jobs read from a file and run in a pipeline (one job's H
+//                is built while the one before is diagonalized and written), with one summary
+//                file (run_batch)
+//      10/17/26  Added -eigtol option: each matrix element integrated only as accurately as
+//                the low-lying eigenvalues need (Hij_budgeted), with its error estimate kept
+//      10/17/26  Added -grid option: the same states from a finite-difference grid in r, a
+//                tridiagonal matrix solved by bisection and inverse iteration (tridiag_eigen.cpp),
+//                as a check of the basis results (solve_on_grid)
 //
 //  Notes:
 //   * Based on the documentation for the GSL library under
@@ -33,14 +69,146 @@
 //      GSL_EIGEN_SORT_VAL_DESC => descending order in numerical value 
 //      GSL_EIGEN_SORT_ABS_ASC => ascending order in magnitude 
 //      GSL_EIGEN_SORT_ABS_DESC => descending order in magnitude
-//   * We use gls_integration_qagiu for the integrals from
-//      0 to Infinity (calculating matrix elements of H).
-//   * Start with l=0 (and generalize later)
+//   * We use gk_integrate_upper (../HW2/gauss_kronrod.cpp, the same
+//      15-point Gauss-Kronrod bisection and x = (1-t)/t mapping as
+//      gsl_integration_qagiu, but with a workspace that is reused
+//      without any allocation) for the integrals from 0 to Infinity
+//      (calculating matrix elements of H, thousands of small ones).
+//   * Any orbital angular momentum l (-l option, default 0).  The
+//      centrifugal term is in the oscillator energies, so the integrands
+//      only change by using the basis with that l.  The output file
+//      compares the lowest state with the lowest hydrogen state for that
+//      l, r^(l+1) exp(-r/(l+1)) (normalized), which is 2r exp(-r) for l=0.
+//   * H doesn't connect different l, so with -lmax L the l = 0,...,L
+//      blocks are independent problems.  Each block is built (with the
+//      same method: -table, -analytic, -sweep or one Hij at a time) and
+//      diagonalized (-lowest k or all) by one thread, with up to N
+//      blocks at once (-threads N; all cores if not given).  The levels
+//      are printed in one list ordered by energy, labeled by (n,l) with
+//      n = 1,2,... within each l (for Coulomb the principal quantum
+//      number is n + l).  No wavefunctions are written in this mode.
+//   * With -optimize b_min b_max, b is not read in.  Instead the ground
+//      state energy E_0(b) is found at num_b_scan values of b from b_min
+//      to b_max (evenly spaced in log b), several at once on threads
+//      (-threads N), and the lowest one and its neighbors are the
+//      starting bracket for Brent's method (gsl_min_fminimizer_brent).
+//      The run then goes on as usual with the best b.  With r = b s,
+//      u_n(r) = u_n(s; b=1)/sqrt(b), so
+//        H_ij = E_j delta_ij + sum_k Phi[k][i] Phi[k][j] D(b s_k)
+//      with Phi tabulated once for b = 1 on a grid in s; each b only
+//      needs the new D_k and one matrix product (Hij_scaled).  This
+//      doesn't work if the potential jumps (the jump in s moves with b),
+//      so then the grid is made again for each b (Hij_tabulated).  With
+//      -analytic the closed forms are used for each b.  (This replaces
+//      comparing b=2 with b=3 by hand; see the comments below.)
+//   * With -cache, the matrix elements integrated one at a time (Hij,
+//      serial or -threads, and -lmax without -table etc.) are saved with
+//      their error estimates in hij_cache_<key>.dat in the current
+//      directory, one file for each potential, set of parameters, b,
+//      mass and l.  A later run uses the saved elements whose errors
+//      meet Hij_abs_error and Hij_rel_error and integrates only the rest
+//      (e.g., the new ones when the dimension goes up).
+//   * With -batch jobfile, nothing is read from cin.  Each line of
+//      jobfile is one job,
+//        potential [parameters] b dimension [output file]
+//      with the potential and parameters as they would be typed in (1
+//      or 2 with no parameters, or a name and its parameters), and no
+//      wavefunction file if the output file is missing or "-".  Blank
+//      lines and lines starting with # are skipped.  The other options
+//      apply to every job.  One thread builds the H matrices (the
+//      assembly stage) while this one diagonalizes them and writes the
+//      files (the solve stage), with at most max_jobs_waiting built
+//      matrices waiting between the two.  A line for each job goes to
+//      the summary file (-summary file, default eigen_basis_summary.dat):
+//      the input, the m lowest energies (-states m), the errors of the
+//      lowest state, the time spent in each stage and whether the
+//      eigenvalues converged ("ok" or "unconverged", with -lowest).  -eigtol, -grid,
+//      -optimize, -lmax and -start are for one run only, and are
+//      rejected with -batch.
+//   * With -eigtol eps, each matrix element is only as accurate as the
+//      m lowest eigenvalues (-states m, or k with -lowest k) need to be
+//      good to about eps (first order in the errors):
+//       * a cheap H (closed forms for Coulomb, the tabulated basis
+//          otherwise) gives a first value of every element and the
+//          eigenvectors v^s.  The error of a tabulated element is
+//          estimated by tabulating again with half as many panels.
+//       * an error dH_ij changes E_s by v_i^s v_j^s dH_ij, so the
+//          errors change E_s by at most sum_ij |v_i^s v_j^s| dH_ij.
+//          With N^2 terms, each element (i,j) gets the tolerance
+//            eps / (N^2 max_s |v_i^s v_j^s|),
+//          so elements that hardly touch the low states (small v_i or
+//          v_j, usually the far-off-diagonal ones) get loose
+//          tolerances.  No tolerance is looser than 10^-3 |H_ij|.
+//       * only the elements whose cheap value misses its tolerance are
+//          integrated (once each, with -threads as for Hij_parallel)
+//      The error of each element is printed (like -sweep), as is the
+//      resulting bound on the error of each of the m eigenvalues.
+//      This is the use for the error estimate of Hij.  -eigtol is only
+//      for this path: it can't be used with -sweep, -table, -analytic
+//      or -lmax.
+//   * With -grid N r_max, the states found in the basis are found again
+//      by finite differences: u_k = u(r_k) at r_k = k h, k = 1,...,N,
+//      h = r_max/(N+1), u(0) = u(r_max) = 0, and
+//        -u'' ~ (2u_k - u_k-1 - u_k+1)/h^2,
+//      so H is tridiagonal, with 1/(m h^2) + l(l+1)/(2m r_k^2) + V(r_k)
+//      on the diagonal and -1/(2m h^2) next to it.  Its lowest
+//      eigenvalues come from Sturm sequence bisection and the
+//      eigenvectors from inverse iteration (tridiag_eigen.cpp): O(N)
+//      memory and roughly O(N) work per state, so N = 10^6 is fine.
+//      The error is O(h^2) (O(h) if V jumps, as for the square well).
+//      Nothing is shared with the basis calculation except V, so the
+//      differences in the energies and in u(r) (at up to 1000 of the
+//      r_k) are a check of both.
+//   * The potentials are listed in potential_registry with their names
+//      and parameters.  Enter a name (coulomb, square_well, morse, 
+//      gaussian) and then the parameters; 1 or 2 still pick Coulomb or
+//      the square well with the usual parameters.  The parameters are 
+//      stored in hij_parameters once, and the Hij integrand for each 
+//      potential is Hij_integrand<V>, so V is called directly (and can
+//      be inlined) instead of going through a switch at every point.
+//      To add a potential, write V_whatever (r, potl_params_ptr) and 
+//      add a line to potential_registry.
+//   * With the -sweep option, all matrix elements are integrated at
+//      once with ts_integrate_multi from ../HW2/tanh_sinh.cpp, so the
+//      basis functions are evaluated once per point for all elements.
+//   * H is symmetric, so only the elements with j >= i are calculated,
+//      N(N+1)/2 integrals instead of N^2.  The -symcheck option also 
+//      calculates H_ji for a few randomly picked pairs to check this.
+//   * With -threads N (N = 0 for all cores), the upper triangle is cut 
+//      into tiles that are integrated by N threads (Hij_parallel).  Each
+//      thread starts with its own queue of tiles and steals from the
+//      others when it runs out.  Each thread allocates one integration
+//      workspace and uses it for all its elements.  This assumes that
+//      ho_radial is thread safe (no static scratch variables).
+//   * With -table, every basis function is evaluated once at each point
+//      r_k of a composite Gauss-Legendre grid (weights w_k), giving 
+//      Phi[k][n] = u_n(r_k) sqrt(w_k).  Then 
+//        H_ij = E_j delta_ij + sum_k Phi[k][i] D_k Phi[k][j],
+//      with D_k = V(r_k) - V_ho(r_k), is one call to gsl_blas_dgemm.
+//      This makes dimensions of several hundred practical.
+//   * With -analytic (Coulomb only), H = T + V_coulomb from closed 
+//      forms (see Hij_analytic).  Other potentials fall back to the
+//      numerical integrals.
+//   * With -lowest k, only the k lowest eigenvalues and eigenvectors 
+//      are found, by LOBPCG (lowest_eigenpairs), instead of all of them
+//      with gsl_eigen_symmv: O(k N^2) work per iteration instead of 
+//      O(N^3), and no N x N eigenvector matrix.  The starting vectors
+//      are unit vectors for the smallest diagonal elements of H, except
+//      that -start file replaces the first with the numbers in file 
+//      (e.g., a ground state from a smaller basis; missing ones are 0).
+//   * Wherever all of the basis functions are needed at the same r 
+//      (-sweep, -table, the output), they come from ho_radial_family,
+//      which is stable for large n and r; ho_radial is only used for 
+//      the single-element integrals.
+//   * The wavefunctions u(r) of the lowest m states (-states m, default
+//      1) are written to the output file on a grid with spacing dr 
+//      (-dr h, default 0.1).  The basis is tabulated on the grid once 
+//      and U = B V is one call to gsl_blas_dgemm.  chisquared, the
+//      largest error and the rms error of the ground state (compared to
+//      2r exp(-r), the hydrogen ground state) are found in the same 
+//      loop that writes the file.
 //
 //  To do:
-//   * Add the Morse potential (function is given but not incorporated)
-//   * Generalize to l>0.
-//   * Make potential selection less kludgy.
 //   * Improve efficiency (reduce run time)
 //   * Split into more files (?) or convert to classes
 //
@@ -56,39 +224,264 @@
 #include <iostream>		// note that .h is omitted
 #include <iomanip>		// note that .h is omitted
 #include <cmath>
+#include <cfloat>
 #include <fstream>		// note that .h is omitted
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <sstream>
+#include <chrono>
+#include <condition_variable>
 using namespace std;
 
 #include <gsl/gsl_eigen.h>	        // gsl eigensystem routines
-#include <gsl/gsl_integration.h>	// gsl integration routines
+#include <gsl/gsl_blas.h>	// gsl matrix multiplication
+#include <gsl/gsl_errno.h>	// gsl status codes
+#include <gsl/gsl_min.h>	// gsl 1-d minimization
+#include "../HW2/tanh_sinh.h"	// tanh-sinh integration of many integrands
+#include "../HW2/integ_routines.h"	// Gauss-Legendre points and weights 
+#include "../HW2/gauss_kronrod.h"	// adaptive Gauss-Kronrod integration
+#include "lobpcg.h"		// lowest eigenpairs by LOBPCG 
+#include "ho_family.h"		// ho_radial for all n at once
+#include "hij_cache.h"		// matrix elements saved between runs
+#include "tridiag_eigen.h"	// tridiagonal eigenvalues by bisection
 
 // structures and function prototypes 
+typedef struct			// structure holding potential parameters 
+{
+  double param1;		// any three parameters 
+  double param2;
+  double param3;
+}
+potential_parameters;
+
 typedef struct			// structure holding Hij parameters 
 {
   int i;			// 1st matrix index 
   int j;			// 2nd matrix index 
   double mass;			// particle mass 
-  double b_ho;			// harmonic oscillator parameter 
-  int potential_index;		// indicates which potential to use 
+  double b_ho;			// harmonic oscillator parameter
+  int l;			// orbital angular momentum
+  int potential_index;		// entry in potential_registry 
+  potential_parameters potl_params;	// parameters of that potential 
 }
 hij_parameters;
 
-typedef struct			// structure holding potential parameters 
+typedef double (*potential_function) (double r,
+				      potential_parameters * potl_params_ptr);
+
+typedef struct			// one potential in the registry 
 {
-  double param1;		// any three parameters 
-  double param2;
-  double param3;
+  const char *name;		// name to pick it by 
+  potential_function V;		// V(r) 
+  double (*integrand) (double x, void *params_ptr);	// Hij integrand 
+  int num_params;		// # of parameters used (param1,...) 
+  const char *param_names[3];
+  double default_params[3];	// used when picked by number 
+  int break_param;		// parameter where V jumps (0 = none) 
 }
-potential_parameters;
+potential_entry;
+
+typedef struct			// block of the upper triangle of H 
+{
+  int i_start, i_end;		// rows i_start <= i < i_end 
+  int j_start, j_end;		// columns j_start <= j < j_end 
+}
+hij_tile;
+
+typedef struct			// tiles waiting for one thread (others 
+{				//  may steal from the front) 
+  deque<hij_tile> tiles;
+  mutex lock;
+}
+tile_queue;
+
+typedef struct			// points and weights for integrals over r 
+{
+  vector<double> r;
+  vector<double> w;
+}
+radial_grid;
+
+typedef struct			// structure for the one-sweep integrals 
+{
+  hij_parameters ho_parameters;	// i and j are not used 
+  int dimension;		// dimension of the basis 
+  vector<double> u_n;		// ho_radial (n+1, ...) at the current r 
+  vector<double> E_n;		// ho_eigenvalue (n+1, ...) 
+}
+sweep_parameters;
+
+typedef struct			// basis tabulated for b = 1 (r = b s)
+{
+  radial_grid grid;		// points s_k and weights in s
+  gsl_matrix *Phi_ptr;		// u_n(s_k; b=1) sqrt(w_k)
+}
+scaled_basis;
+
+typedef struct			// structure for E_0(b)
+{
+  hij_parameters ho_parameters;	// b_ho is the variable
+  int dimension;		// dimension of the basis
+  bool use_analytic;		// closed forms (Coulomb only)
+  const scaled_basis *basis_ptr;	// NULL to tabulate for each b
+}
+b_search_parameters;
+
+typedef struct			// how to build H (command-line options)
+{
+  bool use_sweep;		// all matrix elements in one integration
+  bool use_table;		// tabulated basis and matrix product
+  bool use_analytic;		// closed forms (Coulomb only)
+  bool use_cache;		// matrix elements saved between runs
+  int num_threads;		// threads for Hij_parallel (-1 = serial)
+}
+assembly_options;
+
+typedef struct			// one job for -batch
+{
+  int number;			// line number in the job file
+  hij_parameters ho_parameters;	// potential, b, l, ...
+  int dimension;		// dimension of the basis
+  string output_file;		// wavefunctions ("" = none)
+  gsl_matrix *Hmat_ptr;		// H, once it is built
+  double assembly_seconds;	// time to build H
+}
+batch_job;
+
+typedef struct			// one level of the combined spectrum
+{
+  int n;			// 1 = lowest for this l
+  int l;			// orbital angular momentum
+  double energy;
+}
+nl_level;
 
 // potentials 
 double V_coulomb (double r, potential_parameters * potl_params_ptr);
 double V_square_well (double r, potential_parameters * potl_params_ptr);
 double V_morse (double r, potential_parameters * potl_params_ptr);
+double V_gaussian (double r, potential_parameters * potl_params_ptr);
+double V_of_r (double r, hij_parameters * ho_params_ptr);
+double r_break_point (hij_parameters * ho_params_ptr, double r_max);
+
+// i'th-j'th matrix element of Hamiltonian in ho basis
+const double Hij_abs_error = 1.0e-8;	// to avoid round-off problems
+const double Hij_rel_error = 1.0e-8;	// the result will usually be much better
+double Hij (hij_parameters ho_parameters, gk_workspace * work,
+	    double *error_ptr);
+double Hij_tolerance (hij_parameters ho_parameters,
+		      gk_workspace * work, double abs_error,
+		      double rel_error, double *error_ptr);
+template <potential_function V> double Hij_integrand (double x,
+						      void *params_ptr);
+
+// the registry of potentials (1 and 2 on input are the first two) 
+const potential_entry potential_registry[] = {
+  {"coulomb", &V_coulomb, &Hij_integrand<V_coulomb>,
+   1, {"Ze^2", "", ""}, {1., 0., 0.}, 0},
+  {"square_well", &V_square_well, &Hij_integrand<V_square_well>,
+   2, {"V0", "R", ""}, {50., 1., 0.}, 2},
+  {"morse", &V_morse, &Hij_integrand<V_morse>,
+   2, {"D_eq", "r_eq", ""}, {10., 2., 0.}, 0},
+  {"gaussian", &V_gaussian, &Hij_integrand<V_gaussian>,
+   2, {"V0", "R", ""}, {10., 1., 0.}, 0},
+};
+const int num_potentials = sizeof (potential_registry) 
+                             / sizeof (potential_registry[0]);
+const int coulomb_index = 0;	// the one with closed forms 
+
+// all matrix elements in one integration sweep 
+void Hij_sweep (hij_parameters ho_parameters, int dimension,
+		gsl_matrix * Hmat_ptr, gsl_matrix * Herr_ptr);
+void Hij_vector_integrand (double r, double f[], void *params_ptr);
+
+// the upper triangle split over threads 
+int Hij_parallel (hij_parameters ho_parameters, int dimension,
+		  gsl_matrix * Hmat_ptr, int num_threads,
+		  hij_cache * cache_ptr, const gsl_matrix * Htol_ptr,
+		  gsl_matrix * Herr_ptr);
+void Hij_upper_triangle (hij_parameters ho_parameters, int dimension,
+			 gsl_matrix * Hmat_ptr,
+			 gk_workspace * work,
+			 hij_cache * cache_ptr);
+
+// each element only as accurate as the lowest eigenvalues need
+void Hij_budgeted (hij_parameters ho_parameters, int dimension,
+		   double eigen_tolerance, int num_tracked,
+		   gsl_matrix * Hmat_ptr, gsl_matrix * Herr_ptr,
+		   int num_threads, hij_cache * cache_ptr);
+
+// the cache file for these parameters (0 if ok)
+int open_cache (hij_parameters ho_parameters, int dimension,
+		hij_cache * cache_ptr);
+
+// all matrix elements from the basis tabulated on a grid 
+void make_radial_grid (double r_break, double r_max, int num_panels,
+		       radial_grid & grid);
+int Hij_tabulated (hij_parameters ho_parameters, int dimension,
+		   gsl_matrix * Hmat_ptr);
+int Hij_tabulated_panels (hij_parameters ho_parameters, int dimension,
+			  int num_panels, gsl_matrix * Hmat_ptr);
+void make_scaled_basis (int l, int dimension, scaled_basis & basis);
+void Hij_scaled (hij_parameters ho_parameters, const scaled_basis & basis,
+		 gsl_matrix * Hmat_ptr);
+
+// closed-form matrix elements (Coulomb potential) 
+void Hij_analytic (hij_parameters ho_parameters, int dimension,
+		   gsl_matrix * Hmat_ptr);
 
-// i'th-j'th matrix element of Hamiltonian in ho basis 
-double Hij (hij_parameters ho_parameters);
-double Hij_integrand (double x, void *params_ptr);
+// H by any of the methods (not the debugging output)
+void assemble_hamiltonian (hij_parameters ho_parameters, int dimension,
+			   const assembly_options & options,
+			   gsl_matrix * Hmat_ptr);
+
+// wavefunctions of several states on a grid of r values
+void reconstruct_wavefunctions (const gsl_matrix * states_ptr, int l,
+				double b_ho, const vector<double> & r_grid,
+				gsl_matrix * U_ptr);
+void write_wavefunctions (const char *filename, const gsl_matrix * states_ptr,
+			  int l, double b_ho, double dr, double *chisquare_ptr,
+			  double *max_error_ptr, double *rms_error_ptr);
+
+// the registry index for a potential as typed in (-1 if none)
+int find_potential (const string & answer, bool *read_params_ptr);
+
+// many jobs from a file, in a pipeline
+int run_batch (const char *job_filename, const char *summary_filename,
+	       hij_parameters ho_parameters, const assembly_options & options,
+	       int lowest_k, int num_states, double dr);
+
+// every l block up to l_max, on several threads
+void solve_partial_waves (hij_parameters ho_parameters, int dimension,
+			  int l_max, const assembly_options & options,
+			  int lowest_k, int num_threads,
+			  vector<nl_level> & spectrum);
+
+// the lowest states from a finite-difference grid in r
+int solve_on_grid (hij_parameters ho_parameters, int num_points,
+		   double r_max, int num_levels, vector<double> & energies,
+		   vector<double> & u);
+
+// the b with the lowest ground-state energy
+double ground_state_energy (double b_ho, void *params_ptr);
+double optimize_b (hij_parameters ho_parameters, int dimension,
+		   double b_min, double b_max, bool use_analytic,
+		   int num_threads, double *E_min_ptr);
+
+// for messages from several threads
+mutex cout_lock;
+
+// compare H_ij with H_ji for randomly picked pairs 
+void check_symmetry (hij_parameters ho_parameters, int dimension,
+		     gsl_matrix * Hmat_ptr, int num_pairs,
+		     gk_workspace * work);
 
 // harmonic oscillator routines from harmonic_oscillator.cpp 
 extern double ho_radial (int n, int l, double b_ho, double r);
@@ -99,108 +492,527 @@ inline double sqr (double x)  {return x*x;}
 
 //************************** main program ***************************
 int
-main ()
+main (int argc, char *argv[])
 {
   hij_parameters ho_parameters;  // parameters for the Hamiltonian
 
-  // pick the potential based on the integer "answer" 
-  int answer = 0;
-  while (answer != 1 && answer != 2)	// don't quit until 1 or 2!
+  // options on the command line 
+  bool use_sweep = false;	// all matrix elements in one integration 
+  bool use_symcheck = false;	// check H_ij = H_ji for a few pairs 
+  int num_threads = -1;		// threads for Hij_parallel (-1 = serial) 
+  bool use_table = false;	// tabulated basis and matrix product 
+  bool use_analytic = false;	// closed forms (Coulomb only)
+  bool use_cache = false;	// matrix elements saved between runs
+  double eigen_tolerance = 0.;	// -eigtol target (0 = fixed tolerances)
+  int lowest_k = 0;		// # of eigenpairs by LOBPCG (0 = all) 
+  const char *start_file = NULL;	// starting vector for LOBPCG 
+  int num_states = 1;		// # of wavefunctions to write 
+  double dr = .1;		// spacing of the r grid
+  int l = 0;			// orbital angular momentum
+  int l_max = -1;		// all blocks up to l_max (-1 = just l)
+  double b_min = 0., b_max = 0.;	// range for -optimize (0 = off)
+  int grid_points = 0;		// -grid check (0 = off)
+  double grid_r_max = 0.;	// end of the -grid grid
+  const char *batch_file = NULL;	// job file for -batch
+  const char *summary_file = "eigen_basis_summary.dat";	// for -batch
+  for (int arg = 1; arg < argc; arg++)
+    {
+      if (strcmp (argv[arg], "-sweep") == 0)
+	{
+	  use_sweep = true;
+	}
+      else if (strcmp (argv[arg], "-symcheck") == 0)
+	{
+	  use_symcheck = true;
+	}
+      else if (strcmp (argv[arg], "-table") == 0)
+	{
+	  use_table = true;
+	}
+      else if (strcmp (argv[arg], "-analytic") == 0)
+	{
+	  use_analytic = true;
+	}
+      else if (strcmp (argv[arg], "-cache") == 0)
+	{
+	  use_cache = true;
+	}
+      else if (strcmp (argv[arg], "-eigtol") == 0 && arg + 1 < argc)
+	{
+	  eigen_tolerance = atof (argv[++arg]);
+	}
+      else if (strcmp (argv[arg], "-threads") == 0 && arg + 1 < argc)
+	{
+	  num_threads = atoi (argv[++arg]);
+	}
+      else if (strcmp (argv[arg], "-lowest") == 0 && arg + 1 < argc)
+	{
+	  lowest_k = atoi (argv[++arg]);
+	}
+      else if (strcmp (argv[arg], "-start") == 0 && arg + 1 < argc)
+	{
+	  start_file = argv[++arg];
+	}
+      else if (strcmp (argv[arg], "-states") == 0 && arg + 1 < argc)
+	{
+	  num_states = max (1, atoi (argv[++arg]));
+	}
+      else if (strcmp (argv[arg], "-dr") == 0 && arg + 1 < argc)
+	{
+	  dr = atof (argv[++arg]);
+	}
+      else if (strcmp (argv[arg], "-l") == 0 && arg + 1 < argc)
+	{
+	  l = max (0, atoi (argv[++arg]));
+	}
+      else if (strcmp (argv[arg], "-lmax") == 0 && arg + 1 < argc)
+	{
+	  l_max = max (0, atoi (argv[++arg]));
+	}
+      else if (strcmp (argv[arg], "-grid") == 0 && arg + 2 < argc)
+	{
+	  grid_points = atoi (argv[++arg]);
+	  grid_r_max = atof (argv[++arg]);
+	}
+      else if (strcmp (argv[arg], "-optimize") == 0 && arg + 2 < argc)
+	{
+	  b_min = atof (argv[++arg]);
+	  b_max = atof (argv[++arg]);
+	}
+      else if (strcmp (argv[arg], "-batch") == 0 && arg + 1 < argc)
+	{
+	  batch_file = argv[++arg];
+	}
+      else if (strcmp (argv[arg], "-summary") == 0 && arg + 1 < argc)
+	{
+	  summary_file = argv[++arg];
+	}
+      else
+	{
+	  cout << "usage: " << argv[0] 
+	       << " [-sweep] [-table] [-analytic] [-cache] [-eigtol eps]"
+	       << " [-symcheck] [-threads N]"
+	       << " [-lowest k [-start file]] [-states m] [-dr h]"
+	       << " [-l L | -lmax L] [-optimize b_min b_max] [-grid N r_max]"
+	       << " [-batch file [-summary file]]" << endl
+	       << "  -sweep      compute all matrix elements in one integration"
+	       << endl
+	       << "  -table      compute H from the basis tabulated on a grid"
+	       << endl
+	       << "  -analytic   closed-form matrix elements (Coulomb only)"
+	       << endl
+	       << "  -cache      save matrix elements for later runs (and use"
+	       << " saved ones)" << endl
+	       << "  -eigtol eps integrate each element as accurately as the"
+	       << " lowest eigenvalues need for accuracy eps" << endl
+	       << "  -symcheck   check H_ij = H_ji for a few (i,j) pairs"
+	       << endl
+	       << "  -threads N  compute matrix elements on N threads"
+	       << " (0 = all cores)" << endl
+	       << "  -lowest k   find only the k lowest eigenpairs (LOBPCG)"
+	       << endl
+	       << "  -start file starting vector for -lowest (from file)"
+	       << endl
+	       << "  -states m   write the wavefunctions of the m lowest states"
+	       << endl
+	       << "  -dr h       spacing of the r values in the output file"
+	       << endl
+	       << "  -l L        orbital angular momentum (default 0)"
+	       << endl
+	       << "  -lmax L     spectrum for every l up to L (blocks on threads)"
+	       << endl
+	       << "  -optimize b_min b_max  use the b in [b_min,b_max] with the"
+	       << " lowest ground-state energy" << endl
+	       << "  -grid N r_max  check the states on a finite-difference"
+	       << " grid of N points out to r_max" << endl
+	       << "  -batch file run the jobs in file (potential [parameters]"
+	       << " b dimension [output])" << endl
+	       << "  -summary file  one line per -batch job (default "
+	       << summary_file << ")" << endl;
+	  return (1);
+	}
+    }
+
+  assembly_options options;	// how to build H
+  options.use_sweep = use_sweep;
+  options.use_table = use_table;
+  options.use_analytic = use_analytic;
+  options.use_cache = use_cache;
+  options.num_threads = num_threads;
+
+  // a file full of jobs instead of one from cin
+  if (batch_file != NULL)
     {
-      cout << "Enter 1 for Coulomb or 2 for square well potential: ";
-      cin >> answer;
+      // options that apply to one run only
+      if (eigen_tolerance > 0. || grid_points > 0 || b_max > 0.
+	  || l_max >= 0 || start_file != NULL)
+	{
+	  cout << "-eigtol, -grid, -optimize, -lmax and -start can't be used"
+	    << " with -batch" << endl;
+	  return (1);
+	}
+      ho_parameters.mass = 1.;	// as below
+      ho_parameters.l = l;
+      return (run_batch (batch_file, summary_file, ho_parameters, options,
+			 lowest_k, num_states, dr));
+    }
+
+  // -eigtol is for the elements integrated one at a time
+  if (eigen_tolerance > 0.
+      && (use_sweep || use_table || use_analytic || l_max >= 0))
+    {
+      cout << "-eigtol can't be used with -sweep, -table, -analytic"
+	<< " or -lmax" << endl;
+      return (1);
+    }
+
+  // pick the potential by name (or 1, 2 for Coulomb, square well)
+  int potential_index = -1;
+  bool read_params = true;	// read them unless picked by number 
+  while (potential_index < 0)	// don't quit until we have one!
+    {
+      cout << "Enter the potential (";
+      for (int p = 0; p < num_potentials; p++)
+	{
+	  cout << potential_registry[p].name << ", ";
+	}
+      cout << "or 1 for Coulomb or 2 for square well): ";
+      string answer;
+      if (!(cin >> answer))
+	{
+	  return (1);		// end of input 
+	}
+      potential_index = find_potential (answer, &read_params);
+    }
+  const potential_entry &potential = potential_registry[potential_index];
+  double params[3];		// param1, param2, param3 
+  for (int p = 0; p < 3; p++)
+    {
+      params[p] = potential.default_params[p];
+      if (read_params && p < potential.num_params)
+	{
+	  cout << "Enter " << potential.param_names[p] << ": ";
+	  cin >> params[p];
+	}
+    }
+  ho_parameters.potential_index = potential_index;
+  ho_parameters.potl_params.param1 = params[0];
+  ho_parameters.potl_params.param2 = params[1];
+  ho_parameters.potl_params.param3 = params[2];
+  if (use_analytic && potential_index != coulomb_index)
+    {
+      cout << "no closed form for this potential: integrating" << endl;
+      use_analytic = false;
     }
-  ho_parameters.potential_index = answer;
 
-  // Set up the harmonic oscillator basis 
-  double b_ho;			// ho length parameter 
-  cout << "Enter the oscillator parameter b: ";
-  cin >> b_ho;
+  // Set up the harmonic oscillator basis (b is found with -optimize)
+  bool use_optimize = (b_min > 0. && b_max > b_min);
+  double b_ho = 0.;		// ho length parameter
+  if (!use_optimize)
+    {
+      cout << "Enter the oscillator parameter b: ";
+      cin >> b_ho;
+    }
 
   double mass = 1;		 // measure mass in convenient units 
   double chisquare=0;    // initialize chisquared
-  ho_parameters.mass = mass;    
+  ho_parameters.mass = mass;
   ho_parameters.b_ho = b_ho;
+  ho_parameters.l = l;
 
   // pick the dimension of the basis (matrix) 
   int dimension;		// dimension of the matrices and vectors 
   cout << "Enter the dimension of the basis: ";
   cin >> dimension;
+  if (lowest_k > dimension)
+    {
+      lowest_k = dimension;
+    }
+  if (lowest_k > 0 && num_states > lowest_k)
+    {
+      num_states = lowest_k;	// only lowest_k are found 
+    }
+  if (num_states > dimension)
+    {
+      num_states = dimension;
+    }
+
+  // the best b, if it wasn't given
+  if (use_optimize)
+    {
+      double E_min;
+      b_ho = optimize_b (ho_parameters, dimension, b_min, b_max,
+			 use_analytic, num_threads, &E_min);
+      ho_parameters.b_ho = b_ho;
+      cout << "optimal b = " << setprecision (10) << b_ho
+	<< ", ground-state energy = " << E_min << setprecision (6) << endl;
+    }
+
+  // all the partial waves: just the combined spectrum
+  if (l_max >= 0)
+    {
+      vector<nl_level> spectrum;
+      solve_partial_waves (ho_parameters, dimension, l_max, options,
+			   lowest_k, num_threads, spectrum);
+      cout << "  n  l  energy" << endl;
+      for (size_t level = 0; level < spectrum.size (); level++)
+	{
+	  cout << setw (3) << spectrum[level].n << setw (3)
+	    << spectrum[level].l << "  " << scientific << setprecision (10)
+	    << spectrum[level].energy << endl;
+	}
+      return (0);
+    }
 
   // See the GSL documentation for matrix, vector structures 
   //  Define and allocate space for the vectors, matrices, and workspace 
                                // original gsl matrix with Hamiltonian 
   gsl_matrix *Hmat_ptr = gsl_matrix_alloc (dimension, dimension); 
-                               // gsl vector with eigenvalues 
-  gsl_vector *Eigval_ptr = gsl_vector_alloc (dimension);	
-                               // gsl matrix with eigenvectors 
-  gsl_matrix *Eigvec_ptr = gsl_matrix_alloc (dimension, dimension);	
-                               // the workspace for gsl 
-  gsl_eigen_symmv_workspace *worksp= gsl_eigen_symmv_alloc (dimension);	
-
-  // Load the Hamiltonian matrix pointed to by Hmat_ptr 
-  for (int i = 0; i < dimension; i++)
+                               // workspace for the Hij integrals 
+  gk_workspace *integ_work = gk_workspace_alloc (1000);
+
+  // saved elements from earlier runs, if asked for (only for the
+  //  elements integrated one at a time)
+  bool one_at_a_time = !use_sweep && !use_analytic && !use_table;
+  hij_cache cache;
+  hij_cache *cache_ptr = NULL;
+  if (use_cache && one_at_a_time)
     {
-      for (int j = 0; j < dimension; j++)
+      if (open_cache (ho_parameters, dimension, &cache) == 0)
 	{
-	  ho_parameters.i = i;
-	  ho_parameters.j = j;
-	  gsl_matrix_set (Hmat_ptr, i, j, Hij (ho_parameters));
-	  // print statement for debugging 
-	  cout << "i = " << i << ", j = " << j
-	    << ", Hij = " << Hij (ho_parameters) << endl;
+	  cache_ptr = &cache;
+	  cout << "cache has " << hij_cache_count (cache_ptr, dimension,
+						   Hij_abs_error,
+						   Hij_rel_error)
+	    << " of " << dimension * (dimension + 1) / 2
+	    << " matrix elements" << endl;
+	}
+      else
+	{
+	  cout << "can't use the cache file: integrating" << endl;
+	}
+    }
+
+  // Load the Hamiltonian matrix pointed to by Hmat_ptr
+  bool use_budget = (eigen_tolerance > 0.);	// (so one_at_a_time)
+  if (use_sweep || use_budget)
+    {
+      gsl_matrix *Herr_ptr = gsl_matrix_alloc (dimension, dimension);
+      if (use_sweep)
+	{
+	  Hij_sweep (ho_parameters, dimension, Hmat_ptr, Herr_ptr);
+	}
+      else
+	{
+	  Hij_budgeted (ho_parameters, dimension, eigen_tolerance,
+			max (num_states, lowest_k), Hmat_ptr, Herr_ptr,
+			num_threads, cache_ptr);
+	}
+      for (int i = 0; i < dimension; i++)
+	{
+	  for (int j = 0; j < dimension; j++)
+	    {
+	      // print statement for debugging
+	      cout << "i = " << i << ", j = " << j
+		<< ", Hij = " << gsl_matrix_get (Hmat_ptr, i, j)
+		<< " +/- " << gsl_matrix_get (Herr_ptr, i, j) << endl;
+	    }
+	}
+      gsl_matrix_free (Herr_ptr);
+    }
+  else
+    {
+      if (use_analytic)
+	{
+	  Hij_analytic (ho_parameters, dimension, Hmat_ptr);
+	}
+      else if (use_table)
+	{
+	  int num_points = Hij_tabulated (ho_parameters, dimension, Hmat_ptr);
+	  cout << "tabulated basis on " << num_points << " points" << endl;
+	}
+      else if (num_threads >= 0)
+	{
+	  Hij_parallel (ho_parameters, dimension, Hmat_ptr, num_threads,
+			cache_ptr, NULL, NULL);
+	}
+      else
+	{
+	  Hij_upper_triangle (ho_parameters, dimension, Hmat_ptr,
+			      integ_work, cache_ptr);
+	}
+      for (int i = 0; i < dimension; i++)
+	{
+	  for (int j = 0; j < dimension; j++)
+	    {
+	      // print statement for debugging (the stored value)
+	      cout << "i = " << i << ", j = " << j
+		<< ", Hij = " << gsl_matrix_get (Hmat_ptr, i, j) << endl;
+	    }
+	}
+    }
+  if (cache_ptr != NULL)
+    {
+      hij_cache_close (cache_ptr);
+    }
+  if (use_symcheck)
+    {
+      check_symmetry (ho_parameters, dimension, Hmat_ptr, 5, integ_work);
+    }
+
+  // Allocate a matrix for the eigenvectors of the states to be written
+  gsl_matrix *states_ptr = gsl_matrix_alloc (dimension, num_states);
+  vector<double> basis_energies;	// the lowest ones (for -grid)
+  if (lowest_k > 0)
+    {
+      // Only the lowest_k lowest eigenpairs (H is not changed) 
+      gsl_matrix *X_ptr = gsl_matrix_alloc (dimension, lowest_k);
+      gsl_vector *Eigval_ptr = gsl_vector_alloc (lowest_k);
+      diagonal_start (Hmat_ptr, X_ptr);
+      if (start_file != NULL)
+	{
+	  ifstream start_in (start_file);
+	  if (!start_in)
+	    {
+	      cout << "can't open the starting vector file " << start_file
+		<< endl;
+	      return (1);
+	    }
+	  double component;
+	  for (int n = 0; n < dimension; n++)
+	    {
+	      if (!(start_in >> component))
+		{
+		  component = 0.;	// past the end of the file 
+		}
+	      gsl_matrix_set (X_ptr, n, 0, component);
+	    }
+	}
+      int num_iter;
+      if (lowest_eigenpairs (Hmat_ptr, X_ptr, 1.e-10, 10000,
+			     Eigval_ptr, &num_iter) != 0)
+	{
+	  cout << "LOBPCG did not converge!" << endl;
+	}
+      cout << "LOBPCG took " << num_iter << " iterations" << endl;
+      for (int i = 0; i < lowest_k; i++)
+	{
+	  cout << "eigenvalue " << i+1 << " = " 
+	    << scientific << gsl_vector_get (Eigval_ptr, i) << endl;
+	}
+      cout.unsetf (ios::scientific);
+      gsl_matrix_view X_view = gsl_matrix_submatrix (X_ptr, 0, 0,
+						     dimension, num_states);
+      gsl_matrix_memcpy (states_ptr, &X_view.matrix);
+      for (int i = 0; i < lowest_k; i++)
+	{
+	  basis_energies.push_back (gsl_vector_get (Eigval_ptr, i));
+	}
+      gsl_vector_free (Eigval_ptr);
+      gsl_matrix_free (X_ptr);
+    }
+  else
+    {
+      // gsl vector with eigenvalues, matrix with eigenvectors, workspace 
+      gsl_vector *Eigval_ptr = gsl_vector_alloc (dimension);	
+      gsl_matrix *Eigvec_ptr = gsl_matrix_alloc (dimension, dimension);	
+      gsl_eigen_symmv_workspace *worksp= gsl_eigen_symmv_alloc (dimension);	
+
+      // Find the eigenvalues and eigenvectors of the real, symmetric
+      //  matrix pointed to by Hmat_ptr.  It is partially destroyed
+      //  in the process. The eigenvectors are pointed to by 
+      //  Eigvec_ptr and the eigenvalues by Eigval_ptr.
+      gsl_eigen_symmv (Hmat_ptr, Eigval_ptr, Eigvec_ptr, worksp);
+
+      // Sort the eigenvalues and eigenvectors in ascending order 
+      gsl_eigen_symmv_sort (Eigval_ptr, Eigvec_ptr, GSL_EIGEN_SORT_VAL_ASC);
+      gsl_matrix_view Eigvec_view = gsl_matrix_submatrix (Eigvec_ptr, 0, 0,
+							  dimension, 
+							  num_states);
+      gsl_matrix_memcpy (states_ptr, &Eigvec_view.matrix);
+      for (int i = 0; i < num_states; i++)
+	{
+	  basis_energies.push_back (gsl_vector_get (Eigval_ptr, i));
 	}
+
+      gsl_matrix_free (Eigvec_ptr);
+      gsl_vector_free (Eigval_ptr);
+      gsl_eigen_symmv_free (worksp);
     }
 
-  // Find the eigenvalues and eigenvectors of the real, symmetric
-  //  matrix pointed to by Hmat_ptr.  It is partially destroyed
-  //  in the process. The eigenvectors are pointed to by 
-  //  Eigvec_ptr and the eigenvalues by Eigval_ptr.
-  gsl_eigen_symmv (Hmat_ptr, Eigval_ptr, Eigvec_ptr, worksp);
+  // Print out the results: the wavefunctions in the output file, and
+  //  how far the lowest state is from the exact hydrogen state
+  double max_error, rms_error;
+  write_wavefunctions ("EC#5b1D1", states_ptr, l, b_ho, dr, &chisquare,
+		       &max_error, &rms_error);
+  cout << "chisquared = " << chisquare << ", max |u - u_exact| = "
+    << max_error << ", rms error = " << rms_error << endl;
 
-  // Sort the eigenvalues and eigenvectors in ascending order 
-  gsl_eigen_symmv_sort (Eigval_ptr, Eigvec_ptr, GSL_EIGEN_SORT_VAL_ASC);
+  // the same states from the finite-difference grid (a check)
+  if (grid_points > 0 && grid_r_max > 0.)
+    {
+      int num_levels = basis_energies.size ();
+      vector<double> grid_energies;
+      vector<double> grid_u;	// grid_u[s*grid_points + k] = u_s(r_k)
+      auto start = chrono::steady_clock::now ();
+      int num_counts = solve_on_grid (ho_parameters, grid_points,
+				      grid_r_max, num_levels, grid_energies,
+				      grid_u);
+      double grid_seconds = chrono::duration<double>
+	(chrono::steady_clock::now () - start).count ();
+      cout << "grid of " << grid_points << " points out to r = "
+	<< grid_r_max << ": " << num_counts << " Sturm counts, "
+	<< grid_seconds << " s" << endl;
+
+      // the basis wavefunctions at (up to 1000 of) the grid points
+      double h = grid_r_max / (grid_points + 1);
+      int stride = max (1, grid_points / 1000);
+      vector<double> r_check;
+      for (int k = stride - 1; k < grid_points; k += stride)
+	{
+	  r_check.push_back ((k + 1) * h);
+	}
+      gsl_matrix *U_ptr = gsl_matrix_alloc (r_check.size (), num_states);
+      reconstruct_wavefunctions (states_ptr, l, b_ho, r_check, U_ptr);
+
+      cout << "  n  basis energy       grid energy        difference"
+	<< "    max |u_basis - u_grid|" << endl;
+      num_levels = grid_energies.size ();
+      for (int s = 0; s < num_levels; s++)
+	{
+	  cout << setw (3) << s + 1 << "  " << scientific << setprecision (10)
+	    << basis_energies[s] << "  " << grid_energies[s] << "  "
+	    << setprecision (3) << basis_energies[s] - grid_energies[s];
+	  if (s < num_states)	// (the overall signs can differ)
+	    {
+	      double overlap = 0.;
+	      for (size_t c = 0; c < r_check.size (); c++)
+		{
+		  overlap += gsl_matrix_get (U_ptr, c, s)
+		    * grid_u[(long) s * grid_points + (c + 1) * stride - 1];
+		}
+	      double sign = (overlap < 0.) ? -1. : 1.;
+	      double max_diff = 0.;
+	      for (size_t c = 0; c < r_check.size (); c++)
+		{
+		  max_diff = max (max_diff,
+				  fabs (gsl_matrix_get (U_ptr, c, s) - sign
+					* grid_u[(long) s * grid_points
+						 + (c + 1) * stride - 1]));
+		}
+	      cout << "     " << max_diff;
+	    }
+	  cout << endl;
+	}
+      cout.unsetf (ios::scientific);
+      cout << setprecision (6);
+      gsl_matrix_free (U_ptr);
+    }
 
-  // Print out the results   
-  // Allocate a pointer to one of the eigenvectors of the matrix 
-  gsl_vector *eigenvector_ptr = gsl_vector_alloc (dimension);	
-  ofstream out ("EC#5b1D1");	// open the output file 
-  double r = 0.1;
-  double rend = 10;
-  double dr = .1;
-  out << "r" << " " << "u(r)" << " " << "chisquared" << endl;
-  //for (int i = 0; i < dimension; i++)
-    //{
-      //double eigenvalue = gsl_vector_get (Eigval_ptr, 0);
-      gsl_matrix_get_col (eigenvector_ptr, Eigvec_ptr, 0);
-
-      //cout << "eigenvalue " << i+1 << " = " 
-           //<< scientific << eigenvalue << endl;
-
-      // Don't print the eigenvectors yet . . .
-       //cout << "eigenvector = " << endl;
-	   while (r < rend)
-	   {
-		   double sum=0;
-
-       for (int j = 0; j < dimension; j++)
-       {
-		 sum+=gsl_vector_get (eigenvector_ptr, j) * ho_radial (j+1, 0, b_ho,r);
-         //cout << scientific << gsl_vector_get (eigenvector_ptr, j) << endl;
-	   }
-	   chisquare+=((sum - 2.*r*exp(-r))*(sum - 2.*r*exp(-r)))/(2.*r*exp(-r));
-       out << r << " " << sum << endl;
-	   
-	   r+=dr;
-    }
-    out.close ();
-	
   // free the space used by the vector and matrices  and workspace 
-  gsl_matrix_free (Eigvec_ptr);
-  gsl_vector_free (Eigval_ptr);
   gsl_matrix_free (Hmat_ptr);
-  gsl_vector_free (eigenvector_ptr);
-  gsl_eigen_symmv_free (worksp);
+  gsl_matrix_free (states_ptr);
+  gk_workspace_free (integ_work);
 
   return (0);			// successful completion 
 }
@@ -211,22 +1023,35 @@ main ()
 //  
 // Calculate the i'th-j'th matrix element of the Hamiltonian
 //  in a Harmonic oscillator basis.  This routine just passes
-//  the integrand Hij_integrand to a GSL integration routine
-//  (gsl_integration_qagiu) that integrates it over r from 0
+//  the integrand Hij_integrand to an adaptive Gauss-Kronrod routine
+//  (gk_integrate_upper) that integrates it over r from 0
 //  to infinity
 //
-// Take l=0 only for now 
+// l is ho_parameters.l
+//
+// work must have room for 1000 intervals; it is reused from call to
+//  call (one per thread).  The error estimate goes in *error_ptr
+//  (unless error_ptr is NULL).  If the tolerances can't be met, the
+//  best result is returned (and the error estimate says so).
+//
+// Hij_tolerance is the same with the tolerances abs_error and
+//  rel_error instead of Hij_abs_error and Hij_rel_error.
 //
 //*************************************************************
 double
-Hij (hij_parameters ho_parameters)
+Hij (hij_parameters ho_parameters, gk_workspace * work,
+     double *error_ptr)
 {
-  gsl_integration_workspace *work = gsl_integration_workspace_alloc (1000);
-  gsl_function F_integrand;
+  return (Hij_tolerance (ho_parameters, work, Hij_abs_error, Hij_rel_error,
+			 error_ptr));
+}
 
-  double lower_limit = 0.;	// start integral from 0 (to infinity) 
-  double abs_error = 1.0e-8;	// to avoid round-off problems 
-  double rel_error = 1.0e-8;	// the result will usually be much better 
+double
+Hij_tolerance (hij_parameters ho_parameters,
+	       gk_workspace * work, double abs_error,
+	       double rel_error, double *error_ptr)
+{
+  double lower_limit = 0.;	// start integral from 0 (to infinity)
   double result = 0.;		// the result from the integration 
   double error = 0.;		// the estimated error from the integration 
 
@@ -234,14 +1059,15 @@ Hij (hij_parameters ho_parameters)
 
   params_ptr = &ho_parameters;	// we'll pass i, j, mass, b_ho 
 
-  // set up the integrand 
-  F_integrand.function = &Hij_integrand;
-  F_integrand.params = params_ptr;
-
-  // carry out the integral over r from 0 to infinity 
-  gsl_integration_qagiu (&F_integrand, lower_limit,
-			 abs_error, rel_error, 1000, work, &result, &error);
-  // eventually we should do something with the error estimate 
+  // carry out the integral over r from 0 to infinity (with the
+  //  integrand made for this potential)
+  gk_integrate_upper (potential_registry[ho_parameters.potential_index]
+		      .integrand, params_ptr, lower_limit, abs_error,
+		      rel_error, GK_7_15, work, &result, &error);
+  if (error_ptr != NULL)
+    {
+      *error_ptr = error;	// (for the cache)
+    }
 
   return (result);		// send back the result of the integration 
 }
@@ -255,17 +1081,15 @@ Hij (hij_parameters ho_parameters)
 //      2nd derivative from the Hamiltonian in favor of the
 //      HO energy and potential.  This was checked against an
 //      explicit (but crude) 2nd derivative (now commented).
+//   * one version for each potential V (a template argument), so 
+//      the call to V is fixed when compiling; its parameters were 
+//      stored in hij_parameters once
 //
 //************************************************************
-double
+template <potential_function V> double
 Hij_integrand (double x, void *params_ptr)
 {
-  potential_parameters potl_params;	// parameters to pass to potential 
-  double Zesq;			// Ze^2 for Coulomb potential 
-  double R, V0;			// radius and depth of square well 
-  int potential_index;		// index 1,2,... for potental 
-
-  int l = 0;			// orbital angular momentum 
+  int l;			// orbital angular momentum
   int n_i, n_j;			// principal quantum number (1,2,...) 
   double mass, b_ho;		// local ho parameters 
   double hbar = 1.;		// units with hbar = 1 
@@ -282,9 +1106,9 @@ Hij_integrand (double x, void *params_ptr)
   n_j = ((hij_parameters *) params_ptr)->j + 1;
   mass = ((hij_parameters *) params_ptr)->mass;
   b_ho = ((hij_parameters *) params_ptr)->b_ho;
+  l = ((hij_parameters *) params_ptr)->l;
   omega = hbar / (mass * b_ho * b_ho);	// definition of omega 
   ho_pot = (1. / 2.) * mass * (omega * omega) * (x * x);	// ho pot'l 
-  potential_index = ((hij_parameters *) params_ptr)->potential_index;
 
   // debugging code to calculate 2nd derivative by hand 
   /*
@@ -294,33 +1118,11 @@ Hij_integrand (double x, void *params_ptr)
   deriv2 = -((fp - f) - (f - fm)) / (h * h) / (2. * mass);
   */
 
-  // set up the potential according to potential index 
-  switch (potential_index)
-    {
-    case 1:			// coulomb 
-      Zesq = 1.;
-      potl_params.param1 = Zesq;
-      return (ho_radial (n_i, l, b_ho, x)
-	      * (ho_eigenvalue (n_j, l, b_ho, mass) - ho_pot
-		 + V_coulomb (x, &potl_params))
-	      * ho_radial (n_j, l, b_ho, x));
-      break;
-    case 2:			// square well 
-      R = 1.;
-      V0 = 50.;
-      potl_params.param1 = V0;
-      potl_params.param2 = R;
-      return (ho_radial (n_i, l, b_ho, x)
-	      * (ho_eigenvalue (n_j, l, b_ho, mass) - ho_pot
-		 + V_square_well (x, &potl_params))
-	      * ho_radial (n_j, l, b_ho, x));
-      break;
-    default:
-      cout << "Shouldn't get here!\n";
-      return (1);
-      break;
-    }
-
+  // the potential is the template argument 
+  return (ho_radial (n_i, l, b_ho, x)
+	  * (ho_eigenvalue (n_j, l, b_ho, mass) - ho_pot
+	     + V (x, &((hij_parameters *) params_ptr)->potl_params))
+	  * ho_radial (n_j, l, b_ho, x));
 
   // debugging code to use crude 2nd derivative  
   // return (ho_radial (n_i, l, b_ho, x)
@@ -329,62 +1131,1633 @@ Hij_integrand (double x, void *params_ptr)
 
 }
 
-//************************** Potentials *************************
-
-//************************** V_coulomb ***************************
+//************************** Hij_sweep ***************************
 //
-// Coulomb potential with charge Z:  Ze^2/r
-//  --> hydrogen-like atom
-//
-//   Zesq stands for Ze^2
+// Calculate all of the matrix elements (upper triangle, mirrored) 
+//  with one tanh-sinh integration over r.  At each r the basis 
+//  functions u_n(r) and the potential are evaluated once and then
+//  used for every element, instead of once per element.
+//   * integrates from 0 to r_max, beyond which all of the basis 
+//      functions are negligible (not to infinity, so ho_radial is 
+//      never called at enormous r)
+//   * the square well is split at its radius R, since the integrand 
+//      jumps there
+//   * Herr_ptr gets the error estimate for each element
 //
-//**************************************************************
-double
-V_coulomb (double r, potential_parameters * potl_params_ptr)
+//*************************************************************
+void
+Hij_sweep (hij_parameters ho_parameters, int dimension,
+	   gsl_matrix * Hmat_ptr, gsl_matrix * Herr_ptr)
 {
-  double Zesq = potl_params_ptr->param1;
-
-  return (-Zesq / r);
-}
-
-//**************************************************************
+  int num_elements = dimension * (dimension + 1) / 2;
+  sweep_parameters sweep_params;
+  sweep_params.ho_parameters = ho_parameters;
+  sweep_params.dimension = dimension;
+  sweep_params.u_n.resize (dimension);
+  sweep_params.E_n.resize (dimension);
+  for (int n = 0; n < dimension; n++)
+    {
+      sweep_params.E_n[n] = ho_eigenvalue (n + 1, ho_parameters.l,
+					   ho_parameters.b_ho,
+					   ho_parameters.mass);
+    }
 
-//************************* V_square_well **********************
-//
-// Square well potential of radius R and depth V0
-//
-//**************************************************************
-double
-V_square_well (double r, potential_parameters * potl_params_ptr)
-{
-  double V0 = potl_params_ptr->param1;
-  double R = potl_params_ptr->param2;
+  double abs_error = 1.0e-8;	// same as for the single elements 
+  double rel_error = 1.0e-8;
+  double b_ho = ho_parameters.b_ho;
+  double r_max = b_ho * (sqrt (4. * dimension + 2. * ho_parameters.l + 3.)
+			+ 10.);
+  double r_break = r_break_point (&ho_parameters, r_max);
 
-  if (r < R)
+  vector<double> results (num_elements), errors (num_elements);
+  vector<double> outer_results (num_elements, 0.);
+  vector<double> outer_errors (num_elements, 0.);
+  long num_evals = 0, outer_evals = 0;
+  ts_integrate_multi (&Hij_vector_integrand, num_elements, &sweep_params,
+		      0., r_break, abs_error, rel_error,
+		      results.data (), errors.data (), &num_evals);
+  if (r_break < r_max)
     {
-      return (-V0);		// inside the well of depth V0 
+      ts_integrate_multi (&Hij_vector_integrand, num_elements,
+			  &sweep_params, r_break, r_max, abs_error, rel_error,
+			  outer_results.data (), outer_errors.data (),
+			  &outer_evals);
     }
-  else
+
+  int k = 0;			// index of element (i,j) with j >= i 
+  for (int i = 0; i < dimension; i++)
     {
-      return (0.);		// outside the well 
+      for (int j = i; j < dimension; j++)
+	{
+	  double Hij_value = results[k] + outer_results[k];
+	  double Hij_error = errors[k] + outer_errors[k];
+	  gsl_matrix_set (Hmat_ptr, i, j, Hij_value);
+	  gsl_matrix_set (Hmat_ptr, j, i, Hij_value);
+	  gsl_matrix_set (Herr_ptr, i, j, Hij_error);
+	  gsl_matrix_set (Herr_ptr, j, i, Hij_error);
+	  k++;
+	}
     }
+  lock_guard<mutex> guard (cout_lock);
+  cout << "sweep used " << num_evals + outer_evals
+    << " points for " << num_elements << " matrix elements" << endl;
 }
 
-//************************************************************
-
-//************************** V_morse ***************************
+//************************** Hij_vector_integrand ****************
 //
-// Morse potential with equilibrium bond length r_eq and potential
-//  energy for bond formation D_eq
+// Integrands of all the upper-triangle matrix elements at r, in the
+//  order (0,0), (0,1), ..., (0,N-1), (1,1), ...  Same integrand as 
+//  Hij_integrand.
 //
-//**************************************************************
-double
-V_morse (double r, potential_parameters * potl_params_ptr)
+//*************************************************************
+void
+Hij_vector_integrand (double r, double f[], void *params_ptr)
 {
-  double D_eq = potl_params_ptr->param1;
+  sweep_parameters *sweep_ptr = (sweep_parameters *) params_ptr;
+  int dimension = sweep_ptr->dimension;
+  double mass = sweep_ptr->ho_parameters.mass;
+  double b_ho = sweep_ptr->ho_parameters.b_ho;
+  double hbar = 1.;		// units with hbar = 1 
+  double omega = hbar / (mass * b_ho * b_ho);	// definition of omega 
+  double ho_pot = (1. / 2.) * mass * (omega * omega) * (r * r);
+
+  // the parts shared by all elements, computed once 
+  double V = V_of_r (r, &sweep_ptr->ho_parameters) - ho_pot;
+  double *u_n = sweep_ptr->u_n.data ();
+  ho_radial_family (dimension, sweep_ptr->ho_parameters.l, b_ho, r, u_n);
+
+  int k = 0;
+  for (int i = 0; i < dimension; i++)
+    {
+      for (int j = i; j < dimension; j++)
+	{
+	  f[k++] = u_n[i] * (sweep_ptr->E_n[j] + V) * u_n[j];
+	}
+    }
+}
+
+//************************** make_radial_grid ***********************
+//
+// Composite Gauss-Legendre grid on [0,r_max]: num_panels panels of 
+//  equal width (as near as possible), with a panel edge at r_break
+//  (where the square well jumps) if r_break < r_max.
+//
+//*************************************************************
+void
+make_radial_grid (double r_break, double r_max, int num_panels,
+		  radial_grid & grid)
+{
+  const int pts_per_panel = 16;	// exact for polynomials up to degree 31 
+  double x[pts_per_panel], w[pts_per_panel];
+
+  // panels in [0,r_break] and [r_break,r_max], in proportion to length 
+  int inner_panels = num_panels;
+  if (r_break < r_max)
+    {
+      inner_panels = max (1, int (num_panels * r_break / r_max + 0.5));
+      num_panels = max (num_panels, inner_panels + 1);
+    }
+  grid.r.clear ();
+  grid.w.clear ();
+  for (int panel = 0; panel < num_panels; panel++)
+    {
+      double r_left, r_right;
+      if (panel < inner_panels)
+	{
+	  r_left = r_break * panel / inner_panels;
+	  r_right = r_break * (panel + 1) / inner_panels;
+	}
+      else
+	{
+	  int outer = panel - inner_panels;
+	  int outer_panels = num_panels - inner_panels;
+	  r_left = r_break + (r_max - r_break) * outer / outer_panels;
+	  r_right = r_break + (r_max - r_break) * (outer + 1) / outer_panels;
+	}
+      gauss (pts_per_panel, 0, r_left, r_right, x, w);
+      for (int k = 0; k < pts_per_panel; k++)
+	{
+	  grid.r.push_back (x[k]);
+	  grid.w.push_back (w[k]);
+	}
+    }
+}
+
+//************************** Hij_tabulated ***************************
+//
+// Calculate all of the matrix elements from the basis functions 
+//  tabulated on a shared grid:
+//   * Phi[k][n] = u_n(r_k) sqrt(w_k), the n'th basis function at the 
+//      k'th grid point (each ho_radial call is made once)
+//   * D_k = V(r_k) - V_ho(r_k), the same for every element
+//   * H = Phi^T (D Phi) + diag(E_n) with gsl_blas_dgemm, which is 
+//      blocked for the cache by the BLAS library
+//  The same integrand as Hij_integrand, integrated from 0 to r_max
+//  (as in Hij_sweep).  Roughly one panel per basis function keeps 
+//  the panels shorter than the oscillations of the highest u_n.
+//  Returns the number of grid points.
+//
+// Hij_tabulated_panels is the same with num_panels panels instead of
+//  dimension + 20 (fewer for a cheaper, rougher H).
+//
+//*************************************************************
+int
+Hij_tabulated (hij_parameters ho_parameters, int dimension,
+	       gsl_matrix * Hmat_ptr)
+{
+  return (Hij_tabulated_panels (ho_parameters, dimension, dimension + 20,
+				Hmat_ptr));
+}
+
+int
+Hij_tabulated_panels (hij_parameters ho_parameters, int dimension,
+		      int num_panels, gsl_matrix * Hmat_ptr)
+{
+  int l = ho_parameters.l;	// orbital angular momentum
+  double mass = ho_parameters.mass;
+  double b_ho = ho_parameters.b_ho;
+  double hbar = 1.;		// units with hbar = 1 
+  double omega = hbar / (mass * b_ho * b_ho);	// definition of omega 
+
+  double r_max = b_ho * (sqrt (4. * dimension + 2. * ho_parameters.l + 3.)
+			+ 10.);
+  double r_break = r_break_point (&ho_parameters, r_max);
+  radial_grid grid;
+  make_radial_grid (r_break, r_max, num_panels, grid);
+  int num_points = grid.r.size ();
+
+  // tabulate the basis (Phi) and the potential times the basis (D Phi) 
+  //  (a freshly allocated gsl_matrix is stored row by row, as 
+  //  ho_radial_family_batch fills it) 
+  gsl_matrix *Phi_ptr = gsl_matrix_alloc (num_points, dimension);
+  gsl_matrix *DPhi_ptr = gsl_matrix_alloc (num_points, dimension);
+  ho_radial_family_batch (dimension, l, b_ho, num_points, grid.r.data (),
+			  Phi_ptr->data);
+  for (int k = 0; k < num_points; k++)
+    {
+      double r = grid.r[k];
+      double ho_pot = (1. / 2.) * mass * (omega * omega) * (r * r);
+      double D_k = V_of_r (r, &ho_parameters) - ho_pot;
+      double sqrt_w = sqrt (grid.w[k]);
+      for (int n = 0; n < dimension; n++)
+	{
+	  double Phi_kn = gsl_matrix_get (Phi_ptr, k, n) * sqrt_w;
+	  gsl_matrix_set (Phi_ptr, k, n, Phi_kn);
+	  gsl_matrix_set (DPhi_ptr, k, n, D_k * Phi_kn);
+	}
+    }
+
+  // H = Phi^T (D Phi), then add the oscillator energies 
+  gsl_blas_dgemm (CblasTrans, CblasNoTrans, 1., Phi_ptr, DPhi_ptr,
+		  0., Hmat_ptr);
+  for (int n = 0; n < dimension; n++)
+    {
+      double E_n = ho_eigenvalue (n + 1, l, b_ho, mass);
+      gsl_matrix_set (Hmat_ptr, n, n, gsl_matrix_get (Hmat_ptr, n, n) + E_n);
+    }
+
+  gsl_matrix_free (Phi_ptr);
+  gsl_matrix_free (DPhi_ptr);
+  return (num_points);
+}
+
+//************************** make_scaled_basis *********************
+//
+// The basis for b = 1 tabulated on a Gauss-Legendre grid in s = r/b,
+//  Phi[k][n] = u_n(s_k; b=1) sqrt(w_k), for Hij_scaled.  Same grid as
+//  Hij_tabulated (for b = 1, with no break point); free Phi_ptr with
+//  gsl_matrix_free.
+//
+//*************************************************************
+void
+make_scaled_basis (int l, int dimension, scaled_basis & basis)
+{
+  double s_max = sqrt (4. * dimension + 2. * l + 3.) + 10.;
+  make_radial_grid (s_max, s_max, dimension + 20, basis.grid);
+  int num_points = basis.grid.r.size ();
+
+  basis.Phi_ptr = gsl_matrix_alloc (num_points, dimension);
+  ho_radial_family_batch (dimension, l, 1., num_points,
+			  basis.grid.r.data (), basis.Phi_ptr->data);
+  for (int k = 0; k < num_points; k++)
+    {
+      double sqrt_w = sqrt (basis.grid.w[k]);
+      for (int n = 0; n < dimension; n++)
+	{
+	  gsl_matrix_set (basis.Phi_ptr, k, n,
+			  gsl_matrix_get (basis.Phi_ptr, k, n) * sqrt_w);
+	}
+    }
+}
+
+//************************** Hij_scaled *****************************
+//
+// All of the matrix elements for b = ho_parameters.b_ho from the basis
+//  tabulated for b = 1.  With r = b s, u_n(r) = u_n(s; b=1)/sqrt(b)
+//  and dr = b ds, so
+//    H_ij = E_j delta_ij + sum_k Phi[k][i] D(b s_k) Phi[k][j]
+//  with D(r) = V(r) - V_ho(r) as in Hij_tabulated.  Only D_k changes
+//  with b.  The potential should not jump (see make_scaled_basis).
+//
+//*************************************************************
+void
+Hij_scaled (hij_parameters ho_parameters, const scaled_basis & basis,
+	    gsl_matrix * Hmat_ptr)
+{
+  int dimension = basis.Phi_ptr->size2;
+  int num_points = basis.Phi_ptr->size1;
+  double mass = ho_parameters.mass;
+  double b_ho = ho_parameters.b_ho;
+  double hbar = 1.;		// units with hbar = 1
+  double omega = hbar / (mass * b_ho * b_ho);	// definition of omega
+
+  gsl_matrix *DPhi_ptr = gsl_matrix_alloc (num_points, dimension);
+  for (int k = 0; k < num_points; k++)
+    {
+      double r = b_ho * basis.grid.r[k];
+      double ho_pot = (1. / 2.) * mass * (omega * omega) * (r * r);
+      double D_k = V_of_r (r, &ho_parameters) - ho_pot;
+      for (int n = 0; n < dimension; n++)
+	{
+	  gsl_matrix_set (DPhi_ptr, k, n,
+			  D_k * gsl_matrix_get (basis.Phi_ptr, k, n));
+	}
+    }
+
+  gsl_blas_dgemm (CblasTrans, CblasNoTrans, 1., basis.Phi_ptr, DPhi_ptr,
+		  0., Hmat_ptr);
+  for (int n = 0; n < dimension; n++)
+    {
+      double E_n = ho_eigenvalue (n + 1, ho_parameters.l, b_ho, mass);
+      gsl_matrix_set (Hmat_ptr, n, n, gsl_matrix_get (Hmat_ptr, n, n) + E_n);
+    }
+  gsl_matrix_free (DPhi_ptr);
+}
+
+//************************** ground_state_energy *******************
+//
+// Lowest eigenvalue of H for b = b_ho (params_ptr points to a
+//  b_search_parameters structure), with the matrix elements from
+//  Hij_analytic, Hij_scaled or Hij_tabulated.  In the form needed for
+//  a gsl_function.  If LOBPCG doesn't converge, all the eigenvalues
+//  are found with gsl_eigen_symmv instead (with a warning), so an
+//  unconverged E_0 never gets into the scan or Brent's method.
+//
+//*************************************************************
+double
+ground_state_energy (double b_ho, void *params_ptr)
+{
+  b_search_parameters *search_ptr = (b_search_parameters *) params_ptr;
+  hij_parameters ho_parameters = search_ptr->ho_parameters;
+  int dimension = search_ptr->dimension;
+  ho_parameters.b_ho = b_ho;
+
+  gsl_matrix *Hmat_ptr = gsl_matrix_alloc (dimension, dimension);
+  if (search_ptr->use_analytic)
+    {
+      Hij_analytic (ho_parameters, dimension, Hmat_ptr);
+    }
+  else if (search_ptr->basis_ptr != NULL)
+    {
+      Hij_scaled (ho_parameters, *search_ptr->basis_ptr, Hmat_ptr);
+    }
+  else
+    {
+      Hij_tabulated (ho_parameters, dimension, Hmat_ptr);
+    }
+
+  gsl_matrix *X_ptr = gsl_matrix_alloc (dimension, 1);
+  gsl_vector *Eigval_ptr = gsl_vector_alloc (1);
+  diagonal_start (Hmat_ptr, X_ptr);
+  int num_iter;
+  double E_0;
+  if (lowest_eigenpairs (Hmat_ptr, X_ptr, 1.e-10, 10000, Eigval_ptr,
+			 &num_iter) == 0)
+    {
+      E_0 = gsl_vector_get (Eigval_ptr, 0);
+    }
+  else
+    {
+      {
+	lock_guard<mutex> guard (cout_lock);
+	cout << "LOBPCG did not converge for b = " << b_ho
+	  << ": using gsl_eigen_symmv" << endl;
+      }
+      gsl_vector *All_eigval_ptr = gsl_vector_alloc (dimension);
+      gsl_matrix *Eigvec_ptr = gsl_matrix_alloc (dimension, dimension);
+      gsl_eigen_symmv_workspace *worksp = gsl_eigen_symmv_alloc (dimension);
+      gsl_eigen_symmv (Hmat_ptr, All_eigval_ptr, Eigvec_ptr, worksp);
+      gsl_eigen_symmv_sort (All_eigval_ptr, Eigvec_ptr,
+			    GSL_EIGEN_SORT_VAL_ASC);
+      E_0 = gsl_vector_get (All_eigval_ptr, 0);
+      gsl_eigen_symmv_free (worksp);
+      gsl_matrix_free (Eigvec_ptr);
+      gsl_vector_free (All_eigval_ptr);
+    }
+
+  gsl_vector_free (Eigval_ptr);
+  gsl_matrix_free (X_ptr);
+  gsl_matrix_free (Hmat_ptr);
+  return (E_0);
+}
+
+//************************** optimize_b *****************************
+//
+// The b in [b_min,b_max] with the lowest ground-state energy:
+//   * E_0 at num_b_scan values of b, evenly spaced in log b, computed
+//      on num_threads threads (0 = all cores, -1 = one) that each take
+//      the next b not yet started
+//   * the lowest of these and its neighbors bracket the minimum, which
+//      is then found by Brent's method (parabolic steps where they
+//      work, golden section where they don't) to relative accuracy
+//      b_tolerance
+//   * if the lowest is at an end of the range there is no bracket, and
+//      that end is returned (with a warning); so is the lowest if a
+//      neighbor ties it (gsl_min_fminimizer_set_with_values needs
+//      f(b) strictly below both ends, or it fails with GSL_EINVAL)
+//  Except for a potential that jumps, the basis is tabulated once (for
+//  b = 1) and shared by all the b values.
+//
+//*************************************************************
+double
+optimize_b (hij_parameters ho_parameters, int dimension, double b_min,
+	    double b_max, bool use_analytic, int num_threads,
+	    double *E_min_ptr)
+{
+  const int num_b_scan = 16;	// # of b values in the scan
+  const double b_tolerance = 1.e-6;	// relative accuracy of b
+  const int max_iter = 100;	// Brent steps
+  if (num_threads == 0)
+    {
+      num_threads = int (thread::hardware_concurrency ());
+    }
+  num_threads = max (1, min (num_threads, num_b_scan));
+
+  scaled_basis basis;
+  b_search_parameters search_params;
+  search_params.ho_parameters = ho_parameters;
+  search_params.dimension = dimension;
+  search_params.use_analytic = use_analytic;
+  search_params.basis_ptr = NULL;
+  bool potential_jumps = (r_break_point (&ho_parameters, HUGE_VAL)
+			  < HUGE_VAL);
+  if (!use_analytic && !potential_jumps)
+    {
+      make_scaled_basis (ho_parameters.l, dimension, basis);
+      search_params.basis_ptr = &basis;
+    }
+
+  // the scan, several b values at once
+  vector<double> b_scan (num_b_scan), E_scan (num_b_scan);
+  for (int k = 0; k < num_b_scan; k++)
+    {
+      b_scan[k] = b_min * pow (b_max / b_min, k / (num_b_scan - 1.));
+    }
+  atomic<int> next_b (0);
+  auto worker = [&] ()
+  {
+    int k;
+    while ((k = next_b++) < num_b_scan)
+      {
+	E_scan[k] = ground_state_energy (b_scan[k], &search_params);
+      }
+  };
+  vector<thread> threads;
+  for (int t = 1; t < num_threads; t++)
+    {
+      threads.push_back (thread (worker));
+    }
+  worker ();			// this thread works too
+  for (size_t t = 0; t < threads.size (); t++)
+    {
+      threads[t].join ();
+    }
+  int k_min = 0;
+  for (int k = 0; k < num_b_scan; k++)
+    {
+      cout << "b = " << b_scan[k] << ", E_0 = " << E_scan[k] << endl;
+      if (E_scan[k] < E_scan[k_min])
+	{
+	  k_min = k;
+	}
+    }
+
+  // Brent's method from the bracket around the lowest one
+  double b_best = b_scan[k_min];
+  double E_best = E_scan[k_min];
+  if (k_min == 0 || k_min == num_b_scan - 1)
+    {
+      cout << "lowest energy at the end of the range: widen it!" << endl;
+    }
+  else if (!(E_best < E_scan[k_min - 1] && E_best < E_scan[k_min + 1]))
+    {
+      // a tie (E_0 flat in b) is no bracket for Brent's method
+      cout << "E_0 is flat around b = " << b_best
+	<< ": keeping the scan minimum" << endl;
+    }
+  else
+    {
+      gsl_function F_search;
+      F_search.function = &ground_state_energy;
+      F_search.params = &search_params;
+      gsl_min_fminimizer *minimizer_ptr
+	= gsl_min_fminimizer_alloc (gsl_min_fminimizer_brent);
+      gsl_min_fminimizer_set_with_values (minimizer_ptr, &F_search,
+					  b_best, E_best,
+					  b_scan[k_min - 1], E_scan[k_min - 1],
+					  b_scan[k_min + 1], E_scan[k_min + 1]);
+      int status = GSL_CONTINUE;
+      int iter;
+      for (iter = 0; iter < max_iter && status == GSL_CONTINUE; iter++)
+	{
+	  gsl_min_fminimizer_iterate (minimizer_ptr);
+	  status = gsl_min_test_interval
+	    (gsl_min_fminimizer_x_lower (minimizer_ptr),
+	     gsl_min_fminimizer_x_upper (minimizer_ptr), 0., b_tolerance);
+	}
+      b_best = gsl_min_fminimizer_x_minimum (minimizer_ptr);
+      E_best = gsl_min_fminimizer_f_minimum (minimizer_ptr);
+      cout << "Brent's method took " << iter << " steps" << endl;
+      gsl_min_fminimizer_free (minimizer_ptr);
+    }
+
+  if (search_params.basis_ptr != NULL)
+    {
+      gsl_matrix_free (basis.Phi_ptr);
+    }
+  *E_min_ptr = E_best;
+  return (b_best);
+}
+
+//************************** Hij_analytic ***************************
+//
+// Closed-form matrix elements for the Coulomb potential, H = T + V.
+//  With a = n_i - 1, c = n_j - 1 and hbar*omega = 1/(m b^2):
+//   * kinetic energy (from the ho energies minus <r^2>): tridiagonal,
+//      T_aa = (hbar omega/2) (2a + l + 3/2),
+//      T_a,a+1 = (hbar omega/2) sqrt((a+1)(a + l + 3/2))
+//   * 1/r: a finite sum of Gamma function ratios,
+//      <a|1/r|c> = (1/b) sqrt(q_a q_c) sum_{p=0}^{min(a,c)} 
+//                    g_{a-p} g_{c-p} h_p
+//      with q_a = a!/Gamma(a+l+3/2), g_k = Gamma(k+1/2)/(sqrt(pi) k!)
+//      and h_p = Gamma(p+l+1)/p!.  All the terms are positive.
+//  The ratios are built up by recursion (no overflow, and O(N) calls
+//  to Gamma altogether), so the sums cost O(N^3/6) multiplications.
+//  The sign convention is that of ho_radial (positive near r = 0).
+//
+//*************************************************************
+void
+Hij_analytic (hij_parameters ho_parameters, int dimension,
+	      gsl_matrix * Hmat_ptr)
+{
+  int l = ho_parameters.l;	// orbital angular momentum
+  double mass = ho_parameters.mass;
+  double b_ho = ho_parameters.b_ho;
+  double hbar = 1.;		// units with hbar = 1 
+  double hbar_omega = hbar * hbar / (mass * b_ho * b_ho);
+  double Zesq = ho_parameters.potl_params.param1;
+
+  vector<double> q (dimension), g (dimension), h (dimension);
+  q[0] = 1. / tgamma (l + 1.5);
+  g[0] = 1.;
+  h[0] = tgamma (l + 1.);
+  for (int k = 1; k < dimension; k++)
+    {
+      q[k] = q[k - 1] * k / (k + l + 0.5);
+      g[k] = g[k - 1] * (k - 0.5) / k;
+      h[k] = h[k - 1] * (k + l) / k;
+    }
+
+  for (int a = 0; a < dimension; a++)
+    {
+      for (int c = a; c < dimension; c++)
+	{
+	  double sum = 0.;	// p runs up to min(a,c) = a 
+	  for (int p = 0; p <= a; p++)
+	    {
+	      sum += g[a - p] * g[c - p] * h[p];
+	    }
+	  double Hac = -Zesq * sqrt (q[a] * q[c]) * sum / b_ho;
+	  if (c == a)
+	    {
+	      Hac += 0.5 * hbar_omega * (2. * a + l + 1.5);
+	    }
+	  else if (c == a + 1)
+	    {
+	      Hac += 0.5 * hbar_omega * sqrt ((a + 1.) * (a + l + 1.5));
+	    }
+	  gsl_matrix_set (Hmat_ptr, a, c, Hac);
+	  gsl_matrix_set (Hmat_ptr, c, a, Hac);
+	}
+    }
+}
+
+//************************** Hij_parallel ***************************
+//
+// Calculate the upper triangle of H (and mirror it) on num_threads 
+//  threads (num_threads = 0 means all cores).
+//   * the triangle is cut into tile_size x tile_size tiles, dealt out
+//      to the threads' queues in turn
+//   * a thread takes tiles from the back of its own queue; when that 
+//      is empty it steals from the front of another thread's queue,
+//      so threads that get cheap tiles help out with the rest
+//   * each thread has its own integration workspace; the threads
+//      write to different elements of Hmat_ptr (and of the cache, if
+//      cache_ptr isn't NULL), so no locking there
+//   * with Htol_ptr (not NULL), element (i,j) gets the absolute
+//      tolerance Htol(i,j) instead of Hij_abs_error and Hij_rel_error,
+//      and Herr_ptr must hold the errors of the values already in
+//      Hmat_ptr: only the elements with Herr(i,j) > Htol(i,j) are
+//      integrated (or taken from the cache), and an integral replaces
+//      the value already there only if its error is smaller
+//   * Herr_ptr (if not NULL) gets the error of each new element
+//  Returns the number of elements integrated.
+//
+//*************************************************************
+int
+Hij_parallel (hij_parameters ho_parameters, int dimension,
+	      gsl_matrix * Hmat_ptr, int num_threads, hij_cache * cache_ptr,
+	      const gsl_matrix * Htol_ptr, gsl_matrix * Herr_ptr)
+{
+  const int tile_size = 8;	// rows (and columns) per tile 
+  if (num_threads <= 0)
+    {
+      num_threads = int (thread::hardware_concurrency ());
+    }
+  if (num_threads < 1)
+    {
+      num_threads = 1;
+    }
+
+  vector<tile_queue> queues (num_threads);
+  int num_tiles = 0;
+  for (int i_start = 0; i_start < dimension; i_start += tile_size)
+    {
+      for (int j_start = i_start; j_start < dimension; j_start += tile_size)
+	{
+	  hij_tile tile;
+	  tile.i_start = i_start;
+	  tile.i_end = min (i_start + tile_size, dimension);
+	  tile.j_start = j_start;
+	  tile.j_end = min (j_start + tile_size, dimension);
+	  queues[num_tiles % num_threads].tiles.push_back (tile);
+	  num_tiles++;
+	}
+    }
+
+  vector<int> num_stolen (num_threads, 0);
+  vector<int> num_integrated (num_threads, 0);
+  auto worker = [&] (int me)
+  {
+    gk_workspace *work = gk_workspace_alloc (1000);
+    hij_parameters my_parameters = ho_parameters;
+    while (true)
+      {
+	hij_tile tile;
+	bool found = false;
+	{			// own queue first (last in, first out) 
+	  lock_guard<mutex> guard (queues[me].lock);
+	  if (!queues[me].tiles.empty ())
+	    {
+	      tile = queues[me].tiles.back ();
+	      queues[me].tiles.pop_back ();
+	      found = true;
+	    }
+	}
+	for (int other = 1; other < num_threads && !found; other++)
+	  {			// then steal from the others 
+	    tile_queue &victim = queues[(me + other) % num_threads];
+	    lock_guard<mutex> guard (victim.lock);
+	    if (!victim.tiles.empty ())
+	      {
+		tile = victim.tiles.front ();
+		victim.tiles.pop_front ();
+		found = true;
+		num_stolen[me]++;
+	      }
+	  }
+	if (!found)
+	  {
+	    break;		// no tiles left anywhere 
+	  }
+
+	for (int i = tile.i_start; i < tile.i_end; i++)
+	  {
+	    for (int j = max (i, tile.j_start); j < tile.j_end; j++)
+	      {
+		double abs_error = Hij_abs_error;
+		double rel_error = Hij_rel_error;
+		if (Htol_ptr != NULL)
+		  {
+		    abs_error = gsl_matrix_get (Htol_ptr, i, j);
+		    rel_error = 0.;
+		    if (gsl_matrix_get (Herr_ptr, i, j) <= abs_error)
+		      {
+			continue;	// good enough already
+		      }
+		  }
+		my_parameters.i = i;
+		my_parameters.j = j;
+		double Hij_value, Hij_error;
+		if (cache_ptr != NULL
+		    && hij_cache_get (cache_ptr, i, j, abs_error, rel_error,
+				      &Hij_value))
+		  {
+		    Hij_error = hij_cache_error (cache_ptr, i, j);
+		  }
+		else
+		  {
+		    Hij_value = Hij_tolerance (my_parameters, work, abs_error,
+					       rel_error, &Hij_error);
+		    num_integrated[me]++;
+		    if (Htol_ptr != NULL
+			&& !(Hij_error < gsl_matrix_get (Herr_ptr, i, j)))
+		      {
+			continue;	// no better than before (or nan)
+		      }
+		    if (cache_ptr != NULL)
+		      {
+			hij_cache_put (cache_ptr, i, j, Hij_value, Hij_error);
+		      }
+		  }
+		gsl_matrix_set (Hmat_ptr, i, j, Hij_value);
+		gsl_matrix_set (Hmat_ptr, j, i, Hij_value);
+		if (Herr_ptr != NULL)
+		  {
+		    gsl_matrix_set (Herr_ptr, i, j, Hij_error);
+		    gsl_matrix_set (Herr_ptr, j, i, Hij_error);
+		  }
+	      }
+	  }
+      }
+    gk_workspace_free (work);
+  };
+
+  vector<thread> threads;
+  for (int t = 1; t < num_threads; t++)
+    {
+      threads.push_back (thread (worker, t));
+    }
+  worker (0);			// this thread works too 
+  int total_stolen = num_stolen[0];
+  int total_integrated = num_integrated[0];
+  for (int t = 1; t < num_threads; t++)
+    {
+      threads[t - 1].join ();
+      total_stolen += num_stolen[t];
+      total_integrated += num_integrated[t];
+    }
+  lock_guard<mutex> guard (cout_lock);
+  cout << num_tiles << " tiles on " << num_threads << " threads ("
+    << total_stolen << " stolen)" << endl;
+  return (total_integrated);
+}
+
+//************************** Hij_upper_triangle ********************
+//
+// H is symmetric: calculate the upper triangle one element at a time
+//  (with Hij) and mirror it.  With a cache (cache_ptr not NULL),
+//  elements that are saved there accurately enough aren't integrated,
+//  and the new ones are saved.
+//
+//*************************************************************
+void
+Hij_upper_triangle (hij_parameters ho_parameters, int dimension,
+		    gsl_matrix * Hmat_ptr, gk_workspace * work,
+		    hij_cache * cache_ptr)
+{
+  for (int i = 0; i < dimension; i++)
+    {
+      for (int j = i; j < dimension; j++)
+	{
+	  ho_parameters.i = i;
+	  ho_parameters.j = j;
+	  double Hij_value, Hij_error;
+	  if (cache_ptr == NULL
+	      || !hij_cache_get (cache_ptr, i, j, Hij_abs_error,
+				 Hij_rel_error, &Hij_value))
+	    {
+	      Hij_value = Hij (ho_parameters, work, &Hij_error);
+	      if (cache_ptr != NULL)
+		{
+		  hij_cache_put (cache_ptr, i, j, Hij_value, Hij_error);
+		}
+	    }
+	  gsl_matrix_set (Hmat_ptr, i, j, Hij_value);
+	  gsl_matrix_set (Hmat_ptr, j, i, Hij_value);
+	}
+    }
+}
+
+//************************** Hij_budgeted ***************************
+//
+// The upper triangle of H (mirrored) with each element only as
+//  accurate as needed for the num_tracked lowest eigenvalues to be
+//  good to about eigen_tolerance (first order in the errors; see the
+//  notes at the top).  Herr_ptr gets the estimated error of each
+//  element.
+//   * a cheap H (Hij_analytic for Coulomb, Hij_tabulated otherwise)
+//      gives the eigenvectors v^s for the weights and a first value of
+//      every element; the error of a tabulated element is estimated
+//      from a second tabulation with half as many panels
+//   * element (i,j) gets its own tolerance,
+//        eps / (N^2 max_s |v_i^s v_j^s|),
+//      but no looser than max_looseness |H_ij| (nor tighter than
+//      round-off allows)
+//   * only the elements whose cheap value misses its tolerance are
+//      integrated (or taken from the cache), once each, on num_threads
+//      threads as in Hij_parallel (-1 = one)
+//   * an element that can't reach its tolerance keeps its best value
+//      (and its error estimate says so)
+//
+//*************************************************************
+void
+Hij_budgeted (hij_parameters ho_parameters, int dimension,
+	      double eigen_tolerance, int num_tracked, gsl_matrix * Hmat_ptr,
+	      gsl_matrix * Herr_ptr, int num_threads, hij_cache * cache_ptr)
+{
+  const double tightest = 1.e-13;	// no tighter than this (round-off)
+  const double max_looseness = 1.e-3;	// relative to |H_ij|
+  int num_elements = dimension * (dimension + 1) / 2;
+  num_tracked = max (1, min (num_tracked, dimension));
+
+  // the cheap H (in Hmat_ptr) and the errors of its elements
+  if (ho_parameters.potential_index == coulomb_index)
+    {
+      Hij_analytic (ho_parameters, dimension, Hmat_ptr);
+      for (int i = 0; i < dimension; i++)
+	{
+	  for (int j = 0; j < dimension; j++)
+	    {			// exact but for round-off
+	      gsl_matrix_set (Herr_ptr, i, j, dimension * DBL_EPSILON
+			      * fabs (gsl_matrix_get (Hmat_ptr, i, j)));
+	    }
+	}
+    }
+  else
+    {
+      Hij_tabulated (ho_parameters, dimension, Hmat_ptr);
+      Hij_tabulated_panels (ho_parameters, dimension, (dimension + 20) / 2,
+			    Herr_ptr);
+      for (int i = 0; i < dimension; i++)
+	{
+	  for (int j = 0; j < dimension; j++)
+	    {
+	      gsl_matrix_set (Herr_ptr, i, j,
+			      fabs (gsl_matrix_get (Hmat_ptr, i, j)
+				    - gsl_matrix_get (Herr_ptr, i, j)));
+	    }
+	}
+    }
+
+  // its lowest eigenvectors
+  gsl_matrix *Hcopy_ptr = gsl_matrix_alloc (dimension, dimension);
+  gsl_matrix_memcpy (Hcopy_ptr, Hmat_ptr);	// (symmv destroys it)
+  gsl_vector *Eigval_ptr = gsl_vector_alloc (dimension);
+  gsl_matrix *Eigvec_ptr = gsl_matrix_alloc (dimension, dimension);
+  gsl_eigen_symmv_workspace *worksp = gsl_eigen_symmv_alloc (dimension);
+  gsl_eigen_symmv (Hcopy_ptr, Eigval_ptr, Eigvec_ptr, worksp);
+  gsl_eigen_symmv_sort (Eigval_ptr, Eigvec_ptr, GSL_EIGEN_SORT_VAL_ASC);
+  gsl_eigen_symmv_free (worksp);
+  gsl_vector_free (Eigval_ptr);
+  gsl_matrix_free (Hcopy_ptr);
+
+  // the tolerance of each element: sum_ij |v_i v_j| dH_ij <= eps
+  double num_terms = double (dimension) * dimension;
+  gsl_matrix *Htol_ptr = gsl_matrix_alloc (dimension, dimension);
+  double tightest_used = HUGE_VAL, loosest = 0.;
+  for (int i = 0; i < dimension; i++)
+    {
+      for (int j = i; j < dimension; j++)
+	{
+	  double weight = 0.;
+	  for (int state = 0; state < num_tracked; state++)
+	    {
+	      weight = max (weight,
+			    fabs (gsl_matrix_get (Eigvec_ptr, i, state)
+				  * gsl_matrix_get (Eigvec_ptr, j, state)));
+	    }
+	  double tolerance = (weight > 0.)
+	    ? eigen_tolerance / (num_terms * weight) : HUGE_VAL;
+	  tolerance = min (tolerance,
+			   max_looseness * fabs (gsl_matrix_get (Hmat_ptr,
+								 i, j)));
+	  tolerance = max (tolerance, tightest);
+	  gsl_matrix_set (Htol_ptr, i, j, tolerance);
+	  gsl_matrix_set (Htol_ptr, j, i, tolerance);
+	  tightest_used = min (tightest_used, tolerance);
+	  loosest = max (loosest, tolerance);
+	}
+    }
+
+  // integrate the ones that miss their tolerance
+  int num_integrated = Hij_parallel (ho_parameters, dimension, Hmat_ptr,
+				     (num_threads < 0) ? 1 : num_threads,
+				     cache_ptr, Htol_ptr, Herr_ptr);
+  gsl_matrix_free (Htol_ptr);
+
+  // what the errors mean for the eigenvalues (first order)
+  cout << "error budget " << eigen_tolerance << ": tolerances "
+    << tightest_used << " to " << loosest << ", " << num_integrated << " of "
+    << num_elements << " elements integrated" << endl;
+  for (int state = 0; state < num_tracked; state++)
+    {
+      double bound = 0.;
+      for (int i = 0; i < dimension; i++)
+	{
+	  for (int j = 0; j < dimension; j++)
+	    {
+	      bound += fabs (gsl_matrix_get (Eigvec_ptr, i, state)
+			     * gsl_matrix_get (Eigvec_ptr, j, state))
+		* gsl_matrix_get (Herr_ptr, i, j);
+	    }
+	}
+      cout << "eigenvalue " << state + 1 << ": error from the matrix"
+	<< " elements <= " << bound << endl;
+    }
+  gsl_matrix_free (Eigvec_ptr);
+}
+
+//************************** assemble_hamiltonian ******************
+//
+// H for ho_parameters by the method in options (as picked on the
+//  command line), without the debugging output of main.  Used for
+//  the -lmax blocks and the -batch jobs.
+//
+//*************************************************************
+void
+assemble_hamiltonian (hij_parameters ho_parameters, int dimension,
+		      const assembly_options & options, gsl_matrix * Hmat_ptr)
+{
+  if (options.use_analytic
+      && ho_parameters.potential_index == coulomb_index)
+    {
+      Hij_analytic (ho_parameters, dimension, Hmat_ptr);
+    }
+  else if (options.use_table)
+    {
+      Hij_tabulated (ho_parameters, dimension, Hmat_ptr);
+    }
+  else if (options.use_sweep)
+    {
+      gsl_matrix *Herr_ptr = gsl_matrix_alloc (dimension, dimension);
+      Hij_sweep (ho_parameters, dimension, Hmat_ptr, Herr_ptr);
+      gsl_matrix_free (Herr_ptr);
+    }
+  else
+    {
+      hij_cache cache;
+      hij_cache *cache_ptr = NULL;
+      if (options.use_cache
+	  && open_cache (ho_parameters, dimension, &cache) == 0)
+	{
+	  cache_ptr = &cache;
+	}
+      if (options.num_threads >= 0)
+	{
+	  Hij_parallel (ho_parameters, dimension, Hmat_ptr,
+			options.num_threads, cache_ptr, NULL, NULL);
+	}
+      else
+	{
+	  gk_workspace *work = gk_workspace_alloc (1000);
+	  Hij_upper_triangle (ho_parameters, dimension, Hmat_ptr, work,
+			      cache_ptr);
+	  gk_workspace_free (work);
+	}
+      if (cache_ptr != NULL)
+	{
+	  hij_cache_close (cache_ptr);
+	}
+    }
+}
+
+//************************** solve_partial_waves *******************
+//
+// Build and diagonalize the l = 0,...,l_max blocks of H (H doesn't 
+//  connect different l) on num_threads threads (0 or -1 = all cores).
+//   * each thread takes the next l not yet started, builds that block
+//      with the method picked on the command line and finds its lowest
+//      lowest_k eigenvalues (all of them if lowest_k = 0)
+//   * each block has its own matrices and workspaces (and cache file,
+//      with -cache), so the threads share nothing but the counter for
+//      the next l
+//   * spectrum gets the levels of all the blocks, ordered by energy 
+//      (blocks in order of l for equal energies)
+//
+//*************************************************************
+void
+solve_partial_waves (hij_parameters ho_parameters, int dimension, int l_max,
+		     const assembly_options & options, int lowest_k,
+		     int num_threads, vector<nl_level> & spectrum)
+{
+  assembly_options block_options = options;
+  block_options.num_threads = -1;	// the blocks are already in parallel
+  if (num_threads <= 0)
+    {
+      num_threads = int (thread::hardware_concurrency ());
+    }
+  num_threads = max (1, min (num_threads, l_max + 1));
+
+  vector< vector<double> > block_energies (l_max + 1);
+  atomic<int> next_l (0);
+  auto worker = [&] ()
+  {
+    int l;
+    while ((l = next_l++) <= l_max)
+      {
+	hij_parameters block_parameters = ho_parameters;
+	block_parameters.l = l;
+	gsl_matrix *Hmat_ptr = gsl_matrix_alloc (dimension, dimension);
+	assemble_hamiltonian (block_parameters, dimension, block_options,
+			      Hmat_ptr);
+
+	vector<double> &energies = block_energies[l];
+	if (lowest_k > 0)
+	  {
+	    gsl_matrix *X_ptr = gsl_matrix_alloc (dimension, lowest_k);
+	    gsl_vector *Eigval_ptr = gsl_vector_alloc (lowest_k);
+	    diagonal_start (Hmat_ptr, X_ptr);
+	    int num_iter;
+	    if (lowest_eigenpairs (Hmat_ptr, X_ptr, 1.e-10, 10000,
+				   Eigval_ptr, &num_iter) != 0)
+	      {
+		lock_guard<mutex> guard (cout_lock);
+		cout << "LOBPCG did not converge for l = " << l << "!" << endl;
+	      }
+	    for (int k = 0; k < lowest_k; k++)
+	      {
+		energies.push_back (gsl_vector_get (Eigval_ptr, k));
+	      }
+	    gsl_vector_free (Eigval_ptr);
+	    gsl_matrix_free (X_ptr);
+	  }
+	else
+	  {
+	    gsl_vector *Eigval_ptr = gsl_vector_alloc (dimension);
+	    gsl_eigen_symm_workspace *worksp = gsl_eigen_symm_alloc (dimension);
+	    gsl_eigen_symm (Hmat_ptr, Eigval_ptr, worksp);
+	    for (int k = 0; k < dimension; k++)
+	      {
+		energies.push_back (gsl_vector_get (Eigval_ptr, k));
+	      }
+	    sort (energies.begin (), energies.end ());
+	    gsl_eigen_symm_free (worksp);
+	    gsl_vector_free (Eigval_ptr);
+	  }
+	gsl_matrix_free (Hmat_ptr);
+      }
+  };
+
+  vector<thread> threads;
+  for (int t = 1; t < num_threads; t++)
+    {
+      threads.push_back (thread (worker));
+    }
+  worker ();			// this thread works too 
+  for (size_t t = 0; t < threads.size (); t++)
+    {
+      threads[t].join ();
+    }
+
+  // one list, lowest energy first 
+  spectrum.clear ();
+  for (int l = 0; l <= l_max; l++)
+    {
+      for (size_t k = 0; k < block_energies[l].size (); k++)
+	{
+	  nl_level level;
+	  level.n = k + 1;
+	  level.l = l;
+	  level.energy = block_energies[l][k];
+	  spectrum.push_back (level);
+	}
+    }
+  stable_sort (spectrum.begin (), spectrum.end (),
+	       [] (const nl_level & a, const nl_level & b)
+	       { return (a.energy < b.energy); });
+  cout << "solved " << l_max + 1 << " partial waves on " << num_threads
+    << " threads" << endl;
+}
+
+//************************** solve_on_grid **************************
+//
+// The num_levels lowest energies and u(r) (normalized, u > 0 at small
+//  r) from the finite-difference H on r_k = k h, k = 1,...,num_points,
+//  with h = r_max/(num_points+1) and u = 0 at 0 and r_max (see the
+//  notes at the top).  u[s*num_points + k-1] = u_s(r_k).  Returns the
+//  number of Sturm counts the bisection took.
+//
+//*************************************************************
+int
+solve_on_grid (hij_parameters ho_parameters, int num_points, double r_max,
+	       int num_levels, vector<double> & energies, vector<double> & u)
+{
+  const double bisection_tolerance = 1.e-12;
+  double mass = ho_parameters.mass;
+  int l = ho_parameters.l;
+  double h = r_max / (num_points + 1);
+
+  // the tridiagonal H
+  vector<double> diag (num_points);
+  vector<double> offdiag (num_points - 1, -1. / (2. * mass * h * h));
+  for (int k = 0; k < num_points; k++)
+    {
+      double r = (k + 1) * h;
+      diag[k] = 1. / (mass * h * h) + l * (l + 1) / (2. * mass * r * r)
+	+ V_of_r (r, &ho_parameters);
+    }
+
+  num_levels = min (num_levels, num_points);
+  energies.resize (num_levels);
+  u.resize ((long) num_levels * num_points);
+  int num_counts = tridiag_lowest (num_points, diag.data (), offdiag.data (),
+				   num_levels, bisection_tolerance,
+				   energies.data (), u.data ());
+
+  // normalized to 1 = sum_k u(r_k)^2 h
+  double norm = 1. / sqrt (h);
+  for (size_t k = 0; k < u.size (); k++)
+    {
+      u[k] *= norm;
+    }
+  return (num_counts);
+}
+
+//************************** reconstruct_wavefunctions *************
+//
+// u(r) = sum_n V[n][state] u_n(r) for every state (column of V) and
+//  every r in r_grid, as one matrix product U = B V with the basis 
+//  B[k][n] = u_n(r_k) tabulated once.
+//
+//*************************************************************
+void
+reconstruct_wavefunctions (const gsl_matrix * states_ptr, int l,
+			   double b_ho, const vector<double> & r_grid,
+			   gsl_matrix * U_ptr)
+{
+  int dimension = states_ptr->size1;
+  int num_r = r_grid.size ();
+
+  gsl_matrix *B_ptr = gsl_matrix_alloc (num_r, dimension);
+  ho_radial_family_batch (dimension, l, b_ho, num_r, r_grid.data (),
+			  B_ptr->data);
+  gsl_blas_dgemm (CblasNoTrans, CblasNoTrans, 1., B_ptr, states_ptr,
+		  0., U_ptr);
+  gsl_matrix_free (B_ptr);
+}
+
+//************************** write_wavefunctions ********************
+//
+// Write u(r) for every state (column of states_ptr) to filename (not
+//  if filename is NULL), at r = 0.1, 0.1 + dr, ... up to 10 (r += dr,
+//  as always, so the points don't change).  The lowest state is
+//  compared with the lowest hydrogen state for this l,
+//  N r^(l+1) exp(-r/(l+1)) (N = 2 and 2r exp(-r) for l = 0):
+//  chisquared, the largest |u - u_exact| and the rms error.
+//
+//*************************************************************
+void
+write_wavefunctions (const char *filename, const gsl_matrix * states_ptr,
+		     int l, double b_ho, double dr, double *chisquare_ptr,
+		     double *max_error_ptr, double *rms_error_ptr)
+{
+  int num_states = states_ptr->size2;
+
+  // the r grid
+  double r = 0.1;
+  double rend = 10;
+  vector<double> r_grid;
+  while (r < rend)
+    {
+      r_grid.push_back (r);
+      r+=dr;
+    }
+  int num_r = r_grid.size ();
+
+  // u(r) for every state at every r: U = B V
+  gsl_matrix *U_ptr = gsl_matrix_alloc (num_r, num_states);
+  reconstruct_wavefunctions (states_ptr, l, b_ho, r_grid, U_ptr);
+
+  // write the file and compare the ground state with the exact one
+  double exact_norm = sqrt (pow (2. / (l + 1.), 2 * l + 3)
+			    / tgamma (2. * l + 3.));
+  ofstream out;
+  if (filename != NULL)
+    {
+      out.open (filename);	// open the output file
+      out << "r" << " " << "u(r)";
+      for (int state = 1; state < num_states; state++)
+	{
+	  out << " u_" << state + 1 << "(r)";
+	}
+      out << " " << "chisquared" << endl;
+    }
+  double chisquare = 0.;
+  double max_error = 0.;	// largest |u - u_exact|
+  double sum_sq_error = 0.;	// integral of |u - u_exact|^2
+  for (int k = 0; k < num_r; k++)
+    {
+      r = r_grid[k];
+      double u_exact = (l == 0) ? 2.*r*exp(-r)
+	: exact_norm * pow (r, l + 1) * exp (-r / (l + 1.));
+      double diff = gsl_matrix_get (U_ptr, k, 0) - u_exact;
+      chisquare += diff*diff/u_exact;
+      max_error = max (max_error, fabs (diff));
+      sum_sq_error += diff*diff*dr;
+      if (filename != NULL)
+	{
+	  out << r;
+	  for (int state = 0; state < num_states; state++)
+	    {
+	      out << " " << gsl_matrix_get (U_ptr, k, state);
+	    }
+	  out << endl;
+	}
+    }
+  if (filename != NULL)
+    {
+      out.close ();
+    }
+  *chisquare_ptr = chisquare;
+  *max_error_ptr = max_error;
+  *rms_error_ptr = sqrt (sum_sq_error);
+  gsl_matrix_free (U_ptr);
+}
+
+//************************** check_symmetry ***********************
+//
+// Calculate H_ji (the lower triangle, which is otherwise never 
+//  integrated) for num_pairs randomly picked pairs i < j and compare 
+//  with the stored H_ij.  The integrands differ (E_j vs. E_i in 
+//  Hij_integrand), so this also checks the basis orthonormality and
+//  the integration accuracy.
+//
+//*************************************************************
+void
+check_symmetry (hij_parameters ho_parameters, int dimension,
+		gsl_matrix * Hmat_ptr, int num_pairs,
+		gk_workspace * work)
+{
+  if (dimension < 2)
+    {
+      return;			// no pairs with i < j 
+    }
+  srand (12345);		// same pairs every run 
+  double max_diff = 0.;
+  for (int pair = 0; pair < num_pairs; pair++)
+    {
+      int i = rand () % dimension;
+      int j = rand () % dimension;
+      while (j == i)
+	{
+	  j = rand () % dimension;
+	}
+      if (i > j)
+	{
+	  int temp = i;
+	  i = j;
+	  j = temp;
+	}
+      ho_parameters.i = j;	// the transposed element 
+      ho_parameters.j = i;
+      double Hji_value = Hij (ho_parameters, work, NULL);
+      double diff = fabs (Hji_value - gsl_matrix_get (Hmat_ptr, i, j));
+      cout << "symmetry check: i = " << i << ", j = " << j
+	<< ", Hij = " << gsl_matrix_get (Hmat_ptr, i, j)
+	<< ", Hji = " << Hji_value << ", difference = " << diff << endl;
+      if (diff > max_diff)
+	{
+	  max_diff = diff;
+	}
+    }
+  cout << "largest |Hij - Hji| = " << max_diff << endl;
+}
+
+//************************** find_potential ************************
+//
+// The index in potential_registry of the potential typed in as answer:
+//  its name (then *read_params_ptr = true: the parameters come next)
+//  or 1 or 2 for Coulomb or the square well with the usual parameters
+//  (*read_params_ptr = false).  Returns -1 if there is no such
+//  potential.
+//
+//*************************************************************
+int
+find_potential (const string & answer, bool *read_params_ptr)
+{
+  *read_params_ptr = true;
+  if (answer == "1" || answer == "2")
+    {
+      *read_params_ptr = false;
+      return (atoi (answer.c_str ()) - 1);
+    }
+  for (int p = 0; p < num_potentials; p++)
+    {
+      if (answer == potential_registry[p].name)
+	{
+	  return (p);
+	}
+    }
+  return (-1);
+}
+
+//************************** run_batch *****************************
+//
+// Run all of the jobs in job_filename (see the notes at the top) and
+//  write one line for each to summary_filename.  ho_parameters has
+//  the mass and l for all of them.
+//   * the jobs go through two stages, assembly (H) and solve
+//      (eigenvalues, wavefunction file, summary line); a second thread
+//      does the assembly of the next jobs while this one solves, and
+//      they meet at a queue with room for max_jobs_waiting jobs
+//   * the jobs are solved and written in the order of the file
+//  Returns 0 if all of the lines could be read, all of the jobs
+//  converged (with -lowest) and the summary was written, 1 if not
+//  (nothing is run if the summary file can't be opened).  A job whose
+//  LOBPCG didn't converge is marked "unconverged" in the summary.
+//
+//*************************************************************
+int
+run_batch (const char *job_filename, const char *summary_filename,
+	   hij_parameters ho_parameters, const assembly_options & options,
+	   int lowest_k, int num_states, double dr)
+{
+  const size_t max_jobs_waiting = 2;	// built but not yet solved
+
+  // read the jobs
+  ifstream job_in (job_filename);
+  if (!job_in)
+    {
+      cout << "can't open the job file " << job_filename << endl;
+      return (1);
+    }
+  vector<batch_job> jobs;
+  int status = 0;
+  string line;
+  for (int line_number = 1; getline (job_in, line); line_number++)
+    {
+      istringstream fields (line);
+      string answer;
+      if (!(fields >> answer) || answer[0] == '#')
+	{
+	  continue;		// blank line or comment
+	}
+      batch_job job;
+      job.number = line_number;
+      job.ho_parameters = ho_parameters;
+      job.Hmat_ptr = NULL;
+      bool read_params;
+      int potential_index = find_potential (answer, &read_params);
+      bool ok = (potential_index >= 0);
+      double params[3] = {0., 0., 0.};
+      for (int p = 0; ok && p < 3; p++)
+	{
+	  const potential_entry &potential = potential_registry[potential_index];
+	  params[p] = potential.default_params[p];
+	  if (read_params && p < potential.num_params)
+	    {
+	      ok = bool (fields >> params[p]);
+	    }
+	}
+      ok = ok && (fields >> job.ho_parameters.b_ho >> job.dimension)
+	&& job.ho_parameters.b_ho > 0. && job.dimension > 0;
+      if (!ok)
+	{
+	  cout << job_filename << ", line " << line_number
+	    << ": can't read the job (skipped)" << endl;
+	  status = 1;
+	  continue;
+	}
+      if (!(fields >> job.output_file) || job.output_file == "-")
+	{
+	  job.output_file = "";
+	}
+      job.ho_parameters.potential_index = potential_index;
+      job.ho_parameters.potl_params.param1 = params[0];
+      job.ho_parameters.potl_params.param2 = params[1];
+      job.ho_parameters.potl_params.param3 = params[2];
+      jobs.push_back (job);
+    }
+  int num_jobs = jobs.size ();
+  ofstream summary (summary_filename);
+  if (!summary)
+    {
+      cout << "can't open the summary file " << summary_filename << endl;
+      return (1);
+    }
+
+  // the assembly stage, on its own thread
+  deque<batch_job> ready;	// built, waiting to be solved
+  mutex ready_lock;
+  condition_variable ready_changed;
+  auto assembler = [&] ()
+  {
+    for (int job_index = 0; job_index < num_jobs; job_index++)
+      {
+	batch_job job = jobs[job_index];
+	{			// wait for room in the queue
+	  unique_lock<mutex> guard (ready_lock);
+	  ready_changed.wait (guard, [&]
+			      { return (ready.size () < max_jobs_waiting); });
+	}
+	auto start = chrono::steady_clock::now ();
+	job.Hmat_ptr = gsl_matrix_alloc (job.dimension, job.dimension);
+	assemble_hamiltonian (job.ho_parameters, job.dimension, options,
+			      job.Hmat_ptr);
+	job.assembly_seconds = chrono::duration<double>
+	  (chrono::steady_clock::now () - start).count ();
+	{
+	  lock_guard<mutex> guard (ready_lock);
+	  ready.push_back (job);
+	}
+	ready_changed.notify_all ();
+      }
+  };
+  thread assembly_thread (assembler);
+
+  // the solve stage, here
+  summary << "# job potential param1 param2 param3 b dimension l";
+  for (int state = 0; state < num_states; state++)
+    {
+      summary << " E_" << state + 1;
+    }
+  summary << " chisquared max_error rms_error assembly_s solve_s status"
+    << " output" << endl;
+  summary << setprecision (12);
+  for (int job_index = 0; job_index < num_jobs; job_index++)
+    {
+      batch_job job;
+      {				// wait for the next one to be built
+	unique_lock<mutex> guard (ready_lock);
+	ready_changed.wait (guard, [&] { return (!ready.empty ()); });
+	job = ready.front ();
+	ready.pop_front ();
+      }
+      ready_changed.notify_all ();
+      auto start = chrono::steady_clock::now ();
+
+      // the lowest states (all of them, or the lowest k by LOBPCG)
+      int dimension = job.dimension;
+      int num_found = (lowest_k > 0) ? min (lowest_k, dimension) : dimension;
+      int num_kept = min (num_states, num_found);
+      gsl_vector *Eigval_ptr = gsl_vector_alloc (num_found);
+      gsl_matrix *Eigvec_ptr = gsl_matrix_alloc (dimension, num_found);
+      bool converged = true;
+      if (lowest_k > 0)
+	{
+	  int num_iter;
+	  diagonal_start (job.Hmat_ptr, Eigvec_ptr);
+	  converged = (lowest_eigenpairs (job.Hmat_ptr, Eigvec_ptr, 1.e-10,
+					  10000, Eigval_ptr, &num_iter) == 0);
+	  if (!converged)
+	    {
+	      status = 1;
+	    }
+	}
+      else
+	{
+	  gsl_eigen_symmv_workspace *worksp
+	    = gsl_eigen_symmv_alloc (dimension);
+	  gsl_eigen_symmv (job.Hmat_ptr, Eigval_ptr, Eigvec_ptr, worksp);
+	  gsl_eigen_symmv_sort (Eigval_ptr, Eigvec_ptr,
+				GSL_EIGEN_SORT_VAL_ASC);
+	  gsl_eigen_symmv_free (worksp);
+	}
+      gsl_matrix *states_ptr = gsl_matrix_alloc (dimension, num_kept);
+      gsl_matrix_view Eigvec_view = gsl_matrix_submatrix (Eigvec_ptr, 0, 0,
+							  dimension, num_kept);
+      gsl_matrix_memcpy (states_ptr, &Eigvec_view.matrix);
+
+      // the wavefunction file and the errors of the lowest state
+      double chisquare, max_error, rms_error;
+      const char *output = job.output_file.empty () ? NULL
+	: job.output_file.c_str ();
+      write_wavefunctions (output, states_ptr, job.ho_parameters.l,
+			   job.ho_parameters.b_ho, dr, &chisquare,
+			   &max_error, &rms_error);
+      double solve_seconds = chrono::duration<double>
+	(chrono::steady_clock::now () - start).count ();
+
+      // one line in the summary
+      hij_parameters &params = job.ho_parameters;
+      summary << job.number << " "
+	<< potential_registry[params.potential_index].name << " "
+	<< params.potl_params.param1 << " " << params.potl_params.param2
+	<< " " << params.potl_params.param3 << " " << params.b_ho << " "
+	<< dimension << " " << params.l;
+      for (int state = 0; state < num_states; state++)
+	{
+	  if (state < num_kept)
+	    {
+	      summary << " " << gsl_vector_get (Eigval_ptr, state);
+	    }
+	  else
+	    {
+	      summary << " nan";	// fewer states than asked for
+	    }
+	}
+      summary << " " << chisquare << " " << max_error << " " << rms_error
+	<< " " << job.assembly_seconds << " " << solve_seconds << " "
+	<< (converged ? "ok" : "unconverged") << " "
+	<< (job.output_file.empty () ? "-" : job.output_file) << endl;
+      {
+	lock_guard<mutex> guard (cout_lock);
+	cout << "job " << job_index + 1 << " of " << num_jobs << " (line "
+	  << job.number << "): E_1 = " << gsl_vector_get (Eigval_ptr, 0);
+	if (!converged)
+	  {
+	    cout << " (LOBPCG did not converge!)";
+	  }
+	cout << endl;
+      }
+
+      gsl_matrix_free (states_ptr);
+      gsl_matrix_free (Eigvec_ptr);
+      gsl_vector_free (Eigval_ptr);
+      gsl_matrix_free (job.Hmat_ptr);
+    }
+  assembly_thread.join ();
+  summary.close ();
+  if (!summary)
+    {
+      cout << "error writing the summary file " << summary_filename << endl;
+      return (1);
+    }
+  cout << num_jobs << " jobs done; summary in " << summary_filename << endl;
+  return (status);
+}
+
+//************************** open_cache ****************************
+//
+// Open the cache file for the Hamiltonian in ho_parameters (potential
+//  by name, its parameters, b_ho, mass and l) with room for at least
+//  dimension x dimension.  Returns 0 if ok.
+//
+//*************************************************************
+int
+open_cache (hij_parameters ho_parameters, int dimension,
+	    hij_cache * cache_ptr)
+{
+  double params[3] = {ho_parameters.potl_params.param1,
+                      ho_parameters.potl_params.param2,
+                      ho_parameters.potl_params.param3};
+  return (hij_cache_open
+	  (potential_registry[ho_parameters.potential_index].name, params,
+	   ho_parameters.b_ho, ho_parameters.mass, ho_parameters.l,
+	   dimension, cache_ptr));
+}
+
+//************************** Potentials *************************
+
+//************************** V_of_r ********************************
+//
+// The potential picked in main, with the parameters stored in 
+//  ho_params_ptr (for the routines that need V at each r once, not 
+//  in an integrand for each element)
+//
+//**************************************************************
+double
+V_of_r (double r, hij_parameters * ho_params_ptr)
+{
+  return (potential_registry[ho_params_ptr->potential_index].V
+	  (r, &ho_params_ptr->potl_params));
+}
+
+//************************** r_break_point *************************
+//
+// Where the potential jumps (e.g., R for the square well), so that
+//  integrals can be split there; r_max if it doesn't jump before r_max
+//
+//**************************************************************
+double
+r_break_point (hij_parameters * ho_params_ptr, double r_max)
+{
+  double params[3] = {ho_params_ptr->potl_params.param1,
+                      ho_params_ptr->potl_params.param2,
+                      ho_params_ptr->potl_params.param3};
+  int break_param
+    = potential_registry[ho_params_ptr->potential_index].break_param;
+  if (break_param > 0 && params[break_param - 1] > 0.
+      && params[break_param - 1] < r_max)
+    {
+      return (params[break_param - 1]);
+    }
+  return (r_max);
+}
+
+//**************************************************************
+
+//************************** V_coulomb ***************************
+//
+// Coulomb potential with charge Z:  Ze^2/r
+//  --> hydrogen-like atom
+//
+//   Zesq stands for Ze^2
+//
+//**************************************************************
+double
+V_coulomb (double r, potential_parameters * potl_params_ptr)
+{
+  double Zesq = potl_params_ptr->param1;
+
+  return (-Zesq / r);
+}
+
+//**************************************************************
+
+//************************* V_square_well **********************
+//
+// Square well potential of radius R and depth V0
+//
+//**************************************************************
+double
+V_square_well (double r, potential_parameters * potl_params_ptr)
+{
+  double V0 = potl_params_ptr->param1;
+  double R = potl_params_ptr->param2;
+
+  if (r < R)
+    {
+      return (-V0);		// inside the well of depth V0 
+    }
+  else
+    {
+      return (0.);		// outside the well 
+    }
+}
+
+//************************************************************
+
+//************************** V_morse ***************************
+//
+// Morse potential with equilibrium bond length r_eq and potential
+//  energy for bond formation D_eq
+//
+//**************************************************************
+double
+V_morse (double r, potential_parameters * potl_params_ptr)
+{
+  double D_eq = potl_params_ptr->param1;
   double r_eq = potl_params_ptr->param2;
 
   return ( D_eq * sqr(1. - exp(-(r-r_eq))) );
 }
 
-//**************************************************************
\ No newline at end of file
+//**************************************************************
+
+//************************** V_gaussian ***************************
+//
+// Gaussian well of depth V0 and range R:  -V0 exp(-(r/R)^2)
+//
+//**************************************************************
+double
+V_gaussian (double r, potential_parameters * potl_params_ptr)
+{
+  double V0 = potl_params_ptr->param1;
+  double R = potl_params_ptr->param2;
+
+  return (-V0 * exp (-sqr (r / R)));
+}
+
+//**************************************************************
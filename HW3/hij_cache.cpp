@@ -0,0 +1,225 @@
+//  file: hij_cache.cpp
+//
+//  Matrix elements H_ij and their error estimates kept in a memory-mapped
+//   file from run to run.
+//
+//  Revision history:
+//      17-Oct-2026  original version
+//
+//  Notes:
+//   * The file is a hij_cache_header followed by the entries for the
+//      upper triangle, H_ij at index j(j+1)/2 + i.  Making the file
+//      bigger (ftruncate) fills the new entries with zeros, which is
+//      "not filled yet".
+//   * The key is the 64-bit FNV-1a hash of the bytes of the potential
+//      name, parameters, b_ho, mass and l.  The values themselves are
+//      checked against the header, so a hash collision (or a file from
+//      some other program) just means no cache.
+//   * Uses the POSIX calls open, ftruncate and mmap.
+//   * compile with:  "g++ -Wall -c hij_cache.cpp" or makefile
+//
+//************************************************************************
+
+// include files
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+using namespace std;
+
+#include "hij_cache.h"          // prototypes
+
+// local definitions and helper functions
+const char cache_magic[8] = {'H', 'I', 'J', 'C', 'A', 'C', 'H', 'E'};
+const int cache_version = 1;
+
+static unsigned long long fnv1a (unsigned long long hash, const void *data,
+                                 size_t num_bytes);
+static size_t file_size (int capacity);
+
+//************************************************************************
+
+// Open (or create) the cache file for this Hamiltonian with room for at
+//  least dimension x dimension
+int hij_cache_open (const char *potential_name, const double params[3],
+                    double b_ho, double mass, int l, int dimension,
+                    hij_cache * cache_ptr)
+{
+   // the header this Hamiltonian should have
+   hij_cache_header header;
+   memset (&header, 0, sizeof (header));
+   memcpy (header.magic, cache_magic, sizeof (header.magic));
+   header.version = cache_version;
+   strncpy (header.potential_name, potential_name,
+            sizeof (header.potential_name) - 1);
+   for (int p=0; p<3; p++)
+   {
+     header.params[p] = params[p];
+   }
+   header.b_ho = b_ho;
+   header.mass = mass;
+   header.l = l;
+   unsigned long long key = 14695981039346656037ULL;   // FNV offset basis
+   key = fnv1a (key, header.potential_name, strlen (header.potential_name));
+   key = fnv1a (key, header.params, sizeof (header.params));
+   key = fnv1a (key, &header.b_ho, sizeof (header.b_ho));
+   key = fnv1a (key, &header.mass, sizeof (header.mass));
+   key = fnv1a (key, &header.l, sizeof (header.l));
+   header.key = key;
+
+   char filename[64];
+   snprintf (filename, sizeof (filename), "hij_cache_%016llx.dat", key);
+   int fd = open (filename, O_RDWR | O_CREAT, 0644);
+   if (fd < 0)
+   {
+     return (1);
+   }
+
+   // an old file has to be for the same Hamiltonian
+   struct stat file_stat;
+   fstat (fd, &file_stat);
+   int capacity = dimension;
+   if (file_stat.st_size > 0)
+   {
+     hij_cache_header old_header;
+     if (pread (fd, &old_header, sizeof (old_header), 0)
+           != (ssize_t) sizeof (old_header)
+         || memcmp (old_header.magic, header.magic, sizeof (header.magic)) != 0
+         || old_header.version != header.version
+         || strcmp (old_header.potential_name, header.potential_name) != 0
+         || memcmp (old_header.params, header.params,
+                    sizeof (header.params)) != 0
+         || old_header.b_ho != header.b_ho || old_header.mass != header.mass
+         || old_header.l != header.l || old_header.key != header.key)
+     {
+       close (fd);
+       return (1);
+     }
+     if (old_header.capacity > capacity)
+     {
+       capacity = old_header.capacity;
+     }
+   }
+
+   // grow the file if needed (new entries are zero = not filled)
+   size_t size = file_size (capacity);
+   if ((size_t) file_stat.st_size < size && ftruncate (fd, size) != 0)
+   {
+     close (fd);
+     return (1);
+   }
+   void *map_ptr = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                         fd, 0);
+   if (map_ptr == MAP_FAILED)
+   {
+     close (fd);
+     return (1);
+   }
+   header.capacity = capacity;
+   memcpy (map_ptr, &header, sizeof (header));
+
+   cache_ptr->fd = fd;
+   cache_ptr->size = size;
+   cache_ptr->header_ptr = (hij_cache_header *) map_ptr;
+   cache_ptr->entries
+     = (hij_cache_entry *) ((char *) map_ptr + sizeof (hij_cache_header));
+   return (0);
+}
+
+// Write the elements back and unmap the file
+void hij_cache_close (hij_cache * cache_ptr)
+{
+   msync (cache_ptr->header_ptr, cache_ptr->size, MS_SYNC);
+   munmap (cache_ptr->header_ptr, cache_ptr->size);
+   close (cache_ptr->fd);
+   cache_ptr->header_ptr = NULL;
+   cache_ptr->entries = NULL;
+}
+
+// H_ij from the file, if it is there and accurate enough
+int hij_cache_get (const hij_cache * cache_ptr, int i, int j,
+                   double abs_error, double rel_error, double *value_ptr)
+{
+   if (i > j || j >= cache_ptr->header_ptr->capacity)
+   {
+     return (0);
+   }
+   const hij_cache_entry &entry = cache_ptr->entries[(long) j*(j+1)/2 + i];
+   if (entry.filled == 0
+       || entry.error > fmax (abs_error, rel_error * fabs (entry.value)))
+   {
+     return (0);
+   }
+   *value_ptr = entry.value;
+   return (1);
+}
+
+// The error of the stored H_ij (HUGE_VAL if there isn't one)
+double hij_cache_error (const hij_cache * cache_ptr, int i, int j)
+{
+   if (i > j || j >= cache_ptr->header_ptr->capacity)
+   {
+     return (HUGE_VAL);
+   }
+   const hij_cache_entry &entry = cache_ptr->entries[(long) j*(j+1)/2 + i];
+   return ((entry.filled != 0) ? entry.error : HUGE_VAL);
+}
+
+// Store H_ij and its error, unless the one there is at least as good
+void hij_cache_put (hij_cache * cache_ptr, int i, int j, double value,
+                    double error)
+{
+   if (i > j || j >= cache_ptr->header_ptr->capacity)
+   {
+     return;
+   }
+   hij_cache_entry &entry = cache_ptr->entries[(long) j*(j+1)/2 + i];
+   if (entry.filled != 0 && entry.error <= error)
+   {
+     return;
+   }
+   entry.value = value;
+   entry.error = error;
+   entry.filled = 1;
+}
+
+// Number of elements of the upper triangle that hij_cache_get would return
+int hij_cache_count (const hij_cache * cache_ptr, int dimension,
+                     double abs_error, double rel_error)
+{
+   int count = 0;
+   double value;
+   for (int j=0; j<dimension; j++)
+   {
+     for (int i=0; i<=j; i++)
+     {
+       count += hij_cache_get (cache_ptr, i, j, abs_error, rel_error, &value);
+     }
+   }
+   return (count);
+}
+
+//************************************************************************
+
+// FNV-1a hash of num_bytes bytes, continuing from hash
+static unsigned long long fnv1a (unsigned long long hash, const void *data,
+                                 size_t num_bytes)
+{
+   const unsigned char *bytes = (const unsigned char *) data;
+   for (size_t b=0; b<num_bytes; b++)
+   {
+     hash ^= bytes[b];
+     hash *= 1099511628211ULL;           // FNV prime
+   }
+   return (hash);
+}
+
+// Bytes in a file with room for dimensions up to capacity
+static size_t file_size (int capacity)
+{
+   return (sizeof (hij_cache_header)
+           + (size_t) capacity * (capacity + 1) / 2 * sizeof (hij_cache_entry));
+}
@@ -0,0 +1,91 @@
+//  file: hij_cache.h
+//
+//  Header file for hij_cache.cpp: matrix elements H_ij (upper triangle)
+//   and their error estimates saved in a file, memory mapped, so later
+//   runs with the same Hamiltonian can use them instead of integrating.
+//
+//  Revision History:
+//    17-Oct-2026 --- original version
+//
+//  Notes:
+//   * One file per Hamiltonian, named hij_cache_<key>.dat where key is
+//      a hash of the potential name, its parameters, b_ho, mass and l.
+//      The file header has these values too, and the file is only used
+//      if they match exactly.
+//   * The elements are stored column by column (H_0j, ..., H_jj for
+//      j = 0, 1, ...), so a larger dimension just adds columns to the
+//      end of the file; the elements already there don't move.
+//   * An element is used only if its stored error estimate meets the
+//      tolerance asked for (same test as the gsl integration routines).
+//   * Different threads can put different elements at the same time.
+//
+//************************************************************************
+
+#ifndef HIJ_CACHE_H
+#define HIJ_CACHE_H
+
+#include <cstddef>
+
+typedef struct                  // the start of the file
+{
+  char magic[8];                // "HIJCACHE"
+  int version;
+  int capacity;                 // elements for dimensions up to this
+  char potential_name[32];
+  double params[3];             // potential parameters
+  double b_ho;                  // oscillator parameter
+  double mass;
+  int l;                        // orbital angular momentum
+  int unused;
+  unsigned long long key;       // hash of the above (the file name)
+}
+hij_cache_header;
+
+typedef struct                  // one matrix element
+{
+  double value;
+  double error;                 // estimated absolute error
+  long long filled;             // 0 until the element is put
+}
+hij_cache_entry;
+
+typedef struct                  // an open cache file
+{
+  int fd;                       // file descriptor
+  size_t size;                  // bytes mapped
+  hij_cache_header *header_ptr; // the mapped file
+  hij_cache_entry *entries;     // elements, after the header
+}
+hij_cache;
+
+//  begin: function prototypes
+
+                  // open (or create) the file for this Hamiltonian, with
+                  //  room for the given dimension; returns 0 if ok, 1 if
+                  //  the file can't be used
+extern int hij_cache_open (const char *potential_name, const double params[3],
+                           double b_ho, double mass, int l, int dimension,
+                           hij_cache * cache_ptr);
+                  // write the elements back and unmap the file
+extern void hij_cache_close (hij_cache * cache_ptr);
+                  // H_ij (i <= j) if it is in the file with error at most
+                  //  max(abs_error, rel_error |H_ij|): returns 1 and sets
+                  //  *value_ptr, otherwise returns 0
+extern int hij_cache_get (const hij_cache * cache_ptr, int i, int j,
+                          double abs_error, double rel_error,
+                          double *value_ptr);
+                  // the stored error of H_ij (i <= j), HUGE_VAL if it
+                  //  isn't in the file
+extern double hij_cache_error (const hij_cache * cache_ptr, int i, int j);
+                  // store H_ij (i <= j) and its error (unless a better
+                  //  one is already there)
+extern void hij_cache_put (hij_cache * cache_ptr, int i, int j,
+                           double value, double error);
+                  // how many of the dimension x dimension upper triangle
+                  //  would hij_cache_get return
+extern int hij_cache_count (const hij_cache * cache_ptr, int dimension,
+                            double abs_error, double rel_error);
+
+//  end: function prototypes
+
+#endif
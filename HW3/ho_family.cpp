@@ -0,0 +1,127 @@
+//  file: ho_family.cpp
+//
+//  Radial harmonic oscillator wavefunctions for all n up to N at once,
+//   from the three-term recurrence for normalized Laguerre polynomials.
+//
+//  Revision history:
+//      17-Oct-2026  original version
+//
+//  Notes:
+//   * With x = (r/b)^2, alpha = l + 1/2 and a = n - 1,
+//        u_n(r) = sqrt(2/b) (r/b)^(l+1) exp(-x/2) phi_a(x),
+//      where phi_a = sqrt(a!/Gamma(a+alpha+1)) L_a^alpha(x) obeys
+//        sqrt((a+1)(a+alpha+1)) phi_{a+1}
+//            = (2a+1+alpha-x) phi_a - sqrt(a(a+alpha)) phi_{a-1}
+//      with phi_0 = 1/sqrt(Gamma(alpha+1)).  The normalization is built
+//      into the recurrence, so no factorials or Gamma functions of n
+//      are needed (only the log-Gamma for phi_0).
+//   * The prefactor sqrt(2/b) (r/b)^(l+1) exp(-x/2)/sqrt(Gamma(alpha+1))
+//      underflows at large r while phi_a overflows, so the recurrence
+//      starts from 1 and the prefactor is carried as a logarithm.  Every
+//      few steps phi is rescaled by a power of 2 (exact, no round-off)
+//      and the logarithm corrected.
+//   * The batch version runs the recurrence for all r at once (inner
+//      loops over r, which the compiler can vectorize).
+//   * compile with:  "g++ -Wall -c ho_family.cpp" or makefile
+//
+//************************************************************************
+
+// include files
+#include <cmath>
+#include <vector>
+using namespace std;
+
+#include "ho_family.h"          // prototypes
+
+// local definitions and helper functions
+const int rescale_steps = 8;            // steps between rescaling checks
+const double rescale_limit = 1.e100;    // rescale phi when it is bigger
+
+static void recurrence_coefficients (int N, double alpha,
+                                     vector<double> &one_over_upper,
+                                     vector<double> &lower);
+
+//************************************************************************
+
+// u[n-1] = u_n(r) for n = 1,...,N at one r
+void ho_radial_family (int N, int l, double b_ho, double r, double u[])
+{
+   ho_radial_family_batch (N, l, b_ho, 1, &r, u);
+}
+
+// u[k*N + n-1] = u_n(r[k]) for n = 1,...,N and k = 0,...,num_r-1
+void ho_radial_family_batch (int N, int l, double b_ho, int num_r,
+                             const double r[], double u[])
+{
+   double alpha = l + 0.5;
+   vector<double> one_over_upper, lower;
+   recurrence_coefficients (N, alpha, one_over_upper, lower);
+
+   // log of the prefactor, phi_{a-1} and phi_a (scaled) for each r
+   vector<double> log_scale (num_r), x (num_r);
+   vector<double> phi_last (num_r, 0.), phi (num_r, 1.);
+   double log_constant = 0.5 * log (2. / b_ho) - 0.5 * lgamma (alpha + 1.);
+   for (int k=0; k<num_r; k++)
+   {
+     double s = r[k] / b_ho;
+     x[k] = s * s;
+     if (r[k] > 0.)
+     {
+       log_scale[k] = log_constant + (l + 1.) * log (s) - 0.5 * x[k];
+     }
+     else
+     {
+       log_scale[k] = -HUGE_VAL;      // u_n(0) = 0
+     }
+   }
+
+   for (int a=0; a<N; a++)
+   {
+     for (int k=0; k<num_r; k++)     // u_{a+1} from phi_a
+     {
+       u[k*N + a] = phi[k] * exp (log_scale[k]);
+     }
+     if (a == N-1)
+     {
+       break;
+     }
+     double diagonal = 2.*a + 1. + alpha;
+     for (int k=0; k<num_r; k++)     // phi_{a+1}
+     {
+       double phi_next = ((diagonal - x[k]) * phi[k] - lower[a] * phi_last[k])
+                           * one_over_upper[a];
+       phi_last[k] = phi[k];
+       phi[k] = phi_next;
+     }
+     if ((a + 1) % rescale_steps == 0)
+     {
+       for (int k=0; k<num_r; k++)
+       {
+         if (fabs (phi[k]) > rescale_limit || fabs (phi_last[k]) > rescale_limit)
+         {
+           int exponent;              // |phi| = f 2^exponent, 1/2 <= f < 1
+           frexp (fmax (fabs (phi[k]), fabs (phi_last[k])), &exponent);
+           phi[k] = ldexp (phi[k], -exponent);
+           phi_last[k] = ldexp (phi_last[k], -exponent);
+           log_scale[k] += exponent * M_LN2;
+         }
+       }
+     }
+   }
+}
+
+//************************************************************************
+
+// 1/sqrt((a+1)(a+alpha+1)) and sqrt(a(a+alpha)) for a = 0,...,N-1
+static void recurrence_coefficients (int N, double alpha,
+                                     vector<double> &one_over_upper,
+                                     vector<double> &lower)
+{
+   one_over_upper.resize (N);
+   lower.resize (N);
+   for (int a=0; a<N; a++)
+   {
+     one_over_upper[a] = 1. / sqrt ((a + 1.) * (a + alpha + 1.));
+     lower[a] = sqrt (a * (a + alpha));
+   }
+}
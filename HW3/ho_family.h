@@ -0,0 +1,33 @@
+//  file: ho_family.h
+//
+//  Header file for ho_family.cpp: the radial harmonic oscillator
+//   wavefunctions u_n(r) = ho_radial(n, l, b_ho, r) for all n = 1,...,N
+//   at once, at one r or at a batch of r values.
+//
+//  Revision History:
+//    17-Oct-2026 --- original version
+//
+//  Notes:
+//   * Same normalization and sign convention as ho_radial in
+//      harmonic_oscillator.cpp (u_n(r) > 0 for small r).
+//   * Stable for large n and r (no overflow where ho_radial would
+//      overflow in the Laguerre polynomial).
+//
+//************************************************************************
+
+#ifndef HO_FAMILY_H
+#define HO_FAMILY_H
+
+//  begin: function prototypes
+
+                  // u[n-1] = ho_radial (n, l, b_ho, r) for n = 1,...,N
+extern void ho_radial_family (int N, int l, double b_ho, double r,
+                              double u[]);
+                  // u[k*N + n-1] = ho_radial (n, l, b_ho, r[k]) for
+                  //  k = 0,...,num_r-1 (one row per r, as in a gsl_matrix)
+extern void ho_radial_family_batch (int N, int l, double b_ho, int num_r,
+                                    const double r[], double u[]);
+
+//  end: function prototypes
+
+#endif
@@ -0,0 +1,373 @@
+//  file: lobpcg.cpp
+//
+//  Lowest eigenpairs of a real symmetric matrix H by LOBPCG (Knyazev's
+//   locally optimal block preconditioned conjugate gradient method).
+//
+//  Revision history:
+//      17-Oct-2026  original version (ground state only)
+//      17-Oct-2026  block version for the k lowest eigenpairs
+//      17-Oct-2026  preconditioner from the tridiagonal band of H
+//
+//  Notes:
+//   * Each iteration finds the k lowest Ritz pairs of H in the space
+//      spanned by the columns of
+//        X  the current approximations,
+//        W  the preconditioned residuals T(HX - X E),
+//        P  the change in X from the last iteration,
+//      by diagonalizing H in that (at most 3k-dimensional) space.
+//   * The preconditioner T is (B - sigma)^-1, with B the tridiagonal
+//      band of H and sigma below the lowest eigenvalue of B (by 10% of
+//      it plus the gap to the next one), so that B - sigma is positive
+//      definite and one tridiagonal solve (no pivoting) applies it.
+//      In an oscillator basis the kinetic energy is tridiagonal, with
+//      off-diagonal elements about half of the diagonal ones, which
+//      Jacobi's preconditioner (the diagonal alone) misses.  Measured
+//      for the Coulomb basis (-lowest 4, b = 1): 984 iterations at
+//      N = 300 and 1988 at N = 600 with Jacobi's, 39 and 63 with the
+//      band.  The count still grows with N (roughly like sqrt(N)), and
+//      more for a potential that jumps (square well, N = 200: 442
+//      instead of 1894), so the work is O(k N^2) per iteration times a
+//      slowly growing number of iterations.
+//   * The vectors are orthonormalized (Gram-Schmidt, done twice), and
+//      ones that are nearly dependent on the others are dropped.
+//   * The work per iteration is 2k products of H with a vector plus
+//      O(k^2 N) for the orthonormalization, and the extra memory is
+//      O(k N).
+//   * compile with:  "g++ -Wall -c lobpcg.cpp" or makefile
+//
+//************************************************************************
+
+// include files
+#include <cmath>
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+#include <gsl/gsl_blas.h>       // gsl matrix-vector products
+#include <gsl/gsl_eigen.h>      // gsl eigensystem routines
+
+#include "lobpcg.h"             // prototypes
+#include "tridiag_eigen.h"      // lowest eigenvalues of the band
+
+// local definitions and helper functions
+const double drop_tolerance = 1.e-10;   // relative norm to drop a vector
+
+typedef vector< vector<double> > column_list;   // a list of N-vectors
+
+typedef struct                          // B - sigma = L D L^T, B the
+{                                       //  tridiagonal band of H
+   vector<double> pivot;                // D
+   vector<double> mult;                 // L below the diagonal
+   vector<double> offdiag;              // B next to the diagonal
+}
+band_preconditioner;
+
+static double dot (const vector<double> &u, const vector<double> &v);
+static void multiply (const gsl_matrix * H_ptr, vector<double> &v,
+                      vector<double> &Hv);
+static bool orthonormalize (column_list &basis, vector<double> &v);
+static void make_preconditioner (const gsl_matrix * H_ptr,
+                                 band_preconditioner &prec);
+static void precondition (const band_preconditioner &prec,
+                          vector<double> &r);
+
+//************************************************************************
+
+// The k lowest eigenvalues of H and their eigenvectors, starting from
+//  the columns of X
+int lowest_eigenpairs (const gsl_matrix * H_ptr, gsl_matrix * X_ptr,
+                       double tolerance, int max_iter,
+                       gsl_vector * eigenvalues_ptr, int *num_iter_ptr)
+{
+   int n = H_ptr->size1;
+   int k = X_ptr->size2;
+
+   // orthonormal starting vectors (a dependent one is replaced by a
+   //  unit vector) and the Rayleigh-Ritz pairs in their span
+   column_list X, HX, P;
+   for (int c=0; c<k; c++)
+   {
+     vector<double> x (n);
+     for (int i=0; i<n; i++)
+     {
+       x[i] = gsl_matrix_get (X_ptr, i, c);
+     }
+     for (int unit=0; !orthonormalize (X, x) && unit<n; unit++)
+     {
+       x.assign (n, 0.);
+       x[unit] = 1.;
+     }
+   }
+   column_list basis (X), H_basis;
+   vector<double> E (k);
+   band_preconditioner prec;
+   make_preconditioner (H_ptr, prec);
+
+   int status = 1;
+   int iter;
+   for (iter=0; ; iter++)
+   {
+     // H times the new basis vectors (the X part is already known)
+     for (size_t b=H_basis.size (); b<basis.size (); b++)
+     {
+       H_basis.push_back (vector<double> (n));
+       multiply (H_ptr, basis[b], H_basis.back ());
+     }
+
+     // Rayleigh-Ritz: lowest k eigenvectors of H in the basis
+     int m = basis.size ();
+     gsl_matrix *small_ptr = gsl_matrix_alloc (m, m);
+     for (int a=0; a<m; a++)
+     {
+       for (int b=a; b<m; b++)
+       {
+         double Hab = 0.5 * (dot (basis[a], H_basis[b])
+                             + dot (basis[b], H_basis[a]));
+         gsl_matrix_set (small_ptr, a, b, Hab);
+         gsl_matrix_set (small_ptr, b, a, Hab);
+       }
+     }
+     gsl_vector *small_val_ptr = gsl_vector_alloc (m);
+     gsl_matrix *small_vec_ptr = gsl_matrix_alloc (m, m);
+     gsl_eigen_symmv_workspace *worksp = gsl_eigen_symmv_alloc (m);
+     gsl_eigen_symmv (small_ptr, small_val_ptr, small_vec_ptr, worksp);
+     gsl_eigen_symmv_sort (small_val_ptr, small_vec_ptr,
+                           GSL_EIGEN_SORT_VAL_ASC);
+
+     // new X = basis * Y, and P = the part of it not along the old X
+     column_list new_X (k, vector<double> (n, 0.));
+     column_list new_HX (k, vector<double> (n, 0.));
+     P.assign (k, vector<double> (n, 0.));
+     bool have_P = false;
+     for (int c=0; c<k; c++)
+     {
+       E[c] = gsl_vector_get (small_val_ptr, c);
+       for (int a=0; a<m; a++)
+       {
+         double y = gsl_matrix_get (small_vec_ptr, a, c);
+         for (int i=0; i<n; i++)
+         {
+           new_X[c][i] += y * basis[a][i];
+           new_HX[c][i] += y * H_basis[a][i];
+         }
+         if (a >= k)              // (old X is the first k)
+         {
+           have_P = true;
+           for (int i=0; i<n; i++)
+           {
+             P[c][i] += y * basis[a][i];
+           }
+         }
+       }
+     }
+     X.swap (new_X);
+     HX.swap (new_HX);
+
+     gsl_eigen_symmv_free (worksp);
+     gsl_matrix_free (small_vec_ptr);
+     gsl_vector_free (small_val_ptr);
+     gsl_matrix_free (small_ptr);
+
+     // residuals; done when every one is small enough
+     column_list R (k, vector<double> (n));
+     double max_residual = 0.;
+     for (int c=0; c<k; c++)
+     {
+       for (int i=0; i<n; i++)
+       {
+         R[c][i] = HX[c][i] - E[c] * X[c][i];
+       }
+       max_residual = max (max_residual, sqrt (dot (R[c], R[c])));
+     }
+     if (max_residual < tolerance)
+     {
+       status = 0;
+       break;
+     }
+     if (iter == max_iter)
+     {
+       break;
+     }
+
+     // next basis: X (already orthonormal), then W and P
+     basis = X;
+     H_basis = HX;
+     for (int c=0; c<k; c++)
+     {
+       precondition (prec, R[c]);
+       orthonormalize (basis, R[c]);
+     }
+     for (int c=0; c<k && have_P; c++)
+     {
+       orthonormalize (basis, P[c]);
+     }
+   }
+
+   for (int c=0; c<k; c++)
+   {
+     gsl_vector_set (eigenvalues_ptr, c, E[c]);
+     for (int i=0; i<n; i++)
+     {
+       gsl_matrix_set (X_ptr, i, c, X[c][i]);
+     }
+   }
+   *num_iter_ptr = iter;
+   return (status);
+}
+
+// Lowest eigenvalue of H and its eigenvector, starting from x
+int lowest_eigenpair (const gsl_matrix * H_ptr, gsl_vector * x_ptr,
+                      double tolerance, int max_iter,
+                      double *eigenvalue_ptr, int *num_iter_ptr)
+{
+   int n = H_ptr->size1;
+   gsl_matrix *X_ptr = gsl_matrix_alloc (n, 1);
+   gsl_vector *E_ptr = gsl_vector_alloc (1);
+   for (int i=0; i<n; i++)
+   {
+     gsl_matrix_set (X_ptr, i, 0, gsl_vector_get (x_ptr, i));
+   }
+   int status = lowest_eigenpairs (H_ptr, X_ptr, tolerance, max_iter,
+                                   E_ptr, num_iter_ptr);
+   for (int i=0; i<n; i++)
+   {
+     gsl_vector_set (x_ptr, i, gsl_matrix_get (X_ptr, i, 0));
+   }
+   *eigenvalue_ptr = gsl_vector_get (E_ptr, 0);
+   gsl_vector_free (E_ptr);
+   gsl_matrix_free (X_ptr);
+   return (status);
+}
+
+// Starting vectors: unit vectors for the k smallest diagonal elements
+void diagonal_start (const gsl_matrix * H_ptr, gsl_matrix * X_ptr)
+{
+   int n = H_ptr->size1;
+   int k = X_ptr->size2;
+   vector<int> order (n);
+   for (int i=0; i<n; i++)
+   {
+     order[i] = i;
+   }
+   sort (order.begin (), order.end (), [H_ptr] (int a, int b)
+         { return (gsl_matrix_get (H_ptr, a, a)
+                   < gsl_matrix_get (H_ptr, b, b)); });
+   gsl_matrix_set_zero (X_ptr);
+   for (int c=0; c<k && c<n; c++)
+   {
+     gsl_matrix_set (X_ptr, order[c], c, 1.);
+   }
+}
+
+//************************************************************************
+
+// Dot product of two vectors
+static double dot (const vector<double> &u, const vector<double> &v)
+{
+   double sum = 0.;
+   for (size_t i=0; i<u.size (); i++)
+   {
+     sum += u[i] * v[i];
+   }
+   return (sum);
+}
+
+// Hv = H v (H is symmetric)
+static void multiply (const gsl_matrix * H_ptr, vector<double> &v,
+                      vector<double> &Hv)
+{
+   gsl_vector_view v_view = gsl_vector_view_array (v.data (), v.size ());
+   gsl_vector_view Hv_view = gsl_vector_view_array (Hv.data (), Hv.size ());
+   gsl_blas_dsymv (CblasUpper, 1., H_ptr, &v_view.vector, 0.,
+                   &Hv_view.vector);
+}
+
+// Make v orthonormal to the (orthonormal) basis vectors and add it to
+//  the basis; returns false (and leaves the basis alone) if v is
+//  (nearly) a combination of them
+static bool orthonormalize (column_list &basis, vector<double> &v)
+{
+   double start_norm = sqrt (dot (v, v));
+   if (start_norm == 0.)
+   {
+     return (false);
+   }
+   for (int pass=0; pass<2; pass++)  // twice is enough (Kahan)
+   {
+     for (size_t b=0; b<basis.size (); b++)
+     {
+       double overlap = dot (basis[b], v);
+       for (size_t i=0; i<v.size (); i++)
+       {
+         v[i] -= overlap * basis[b][i];
+       }
+     }
+   }
+   double norm = sqrt (dot (v, v));
+   if (norm < drop_tolerance * start_norm)
+   {
+     return (false);
+   }
+   for (size_t i=0; i<v.size (); i++)
+   {
+     v[i] /= norm;
+   }
+   basis.push_back (v);
+   return (true);
+}
+
+// Factor B - sigma (B the tridiagonal band of H) for precondition
+static void make_preconditioner (const gsl_matrix * H_ptr,
+                                 band_preconditioner &prec)
+{
+   int n = H_ptr->size1;
+   vector<double> diag (n);
+   prec.offdiag.assign (max (n-1, 0), 0.);
+   for (int i=0; i<n; i++)
+   {
+     diag[i] = gsl_matrix_get (H_ptr, i, i);
+     if (i < n-1)
+     {
+       prec.offdiag[i] = gsl_matrix_get (H_ptr, i, i+1);
+     }
+   }
+
+   // sigma below the lowest eigenvalue of B
+   int num_band = min (2, n);
+   double band_E[2];
+   vector<double> band_vectors (num_band * n);
+   tridiag_lowest (n, diag.data (), prec.offdiag.data (), num_band, 1.e-10,
+                   band_E, band_vectors.data ());
+   double gap = (num_band > 1) ? band_E[1] - band_E[0] : 0.;
+   double margin = 0.1 * (fabs (band_E[0]) + gap) + 1.e-12;
+   double sigma = band_E[0] - margin;
+
+   // B - sigma = L D L^T (positive definite, so no pivoting)
+   prec.pivot.resize (n);
+   prec.mult.assign (max (n-1, 0), 0.);
+   prec.pivot[0] = diag[0] - sigma;
+   for (int i=1; i<n; i++)
+   {
+     prec.mult[i-1] = prec.offdiag[i-1] / prec.pivot[i-1];
+     prec.pivot[i] = diag[i] - sigma - prec.mult[i-1] * prec.offdiag[i-1];
+   }
+}
+
+// r <- (B - sigma)^-1 r
+static void precondition (const band_preconditioner &prec,
+                          vector<double> &r)
+{
+   int n = r.size ();
+   for (int i=1; i<n; i++)
+   {
+     r[i] -= prec.mult[i-1] * r[i-1];
+   }
+   for (int i=0; i<n; i++)
+   {
+     r[i] /= prec.pivot[i];
+   }
+   for (int i=n-2; i>=0; i--)
+   {
+     r[i] -= prec.mult[i] * r[i+1];
+   }
+}
@@ -0,0 +1,323 @@
+//  file: tridiag_eigen.cpp
+//
+//  Lowest eigenvalues and eigenvectors of a real symmetric tridiagonal
+//   matrix by Sturm sequence bisection and inverse iteration.
+//
+//  Revision history:
+//      17-Oct-2026  original version
+//
+//  Notes:
+//   * Sturm count: with q_0 = d_0 - x and
+//        q_i = d_i - x - e_(i-1)^2 / q_(i-1),
+//      the number of negative q_i is the number of eigenvalues less
+//      than x (the q_i are the pivots of the LDL^T factorization of
+//      T - x).  A zero q_i is replaced by a tiny negative number.
+//   * Bisection: each eigenvalue E_s is kept in a bracket
+//      [lower_s, upper_s).  Every count at x narrows the brackets of
+//      all the eigenvalues not found yet, so the later ones start from
+//      much smaller brackets.  The first brackets are the Gerschgorin
+//      bounds.
+//   * Inverse iteration: T - E is factored once (Gaussian elimination
+//      with partial pivoting, so U has two superdiagonals, as in
+//      LAPACK's dgttrf) and x <- (T - E)^-1 x is repeated until the
+//      growth of x says the residual is at the round-off level (plus
+//      one more solve).  Each x is made orthogonal to the eigenvectors
+//      already found, which matters only if eigenvalues are close.
+//   * The sign of each eigenvector is picked so that its first
+//      component that is not tiny is positive (u(r) > 0 at small r).
+//   * compile with:  "g++ -Wall -c tridiag_eigen.cpp" or makefile
+//
+//************************************************************************
+
+// include files
+#include <cmath>
+#include <cfloat>
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+#include "tridiag_eigen.h"      // prototypes
+
+// local definitions and helper functions
+const int max_inverse_iter = 8;         // solves with T - E per vector
+
+typedef struct                          // P (T - E) = L U
+{
+   vector<double> d;                    // diagonal of U
+   vector<double> du;                   // first superdiagonal of U
+   vector<double> du2;                  // second superdiagonal of U
+   vector<double> dl;                   // multipliers (L)
+   vector<char> swapped;                // rows i and i+1 were swapped
+   double norm;                         // largest row sum of |T - E|
+}
+tridiag_lu;
+
+static void gerschgorin (int n, const double diag[], const double offdiag[],
+                         double *lower_ptr, double *upper_ptr);
+static void factor (int n, const double diag[], const double offdiag[],
+                    double E, tridiag_lu &lu);
+static void solve (int n, const tridiag_lu &lu, double x[]);
+static void inverse_iteration (int n, const double diag[],
+                               const double offdiag[], double E,
+                               int num_prev, const double prev[],
+                               double x[]);
+
+//************************************************************************
+
+// Number of eigenvalues of T less than x
+int sturm_count (int n, const double diag[], const double offdiag[],
+                 double x)
+{
+   int count = 0;
+   double q = 1.;
+   for (int i=0; i<n; i++)
+   {
+     double e_sq = (i > 0) ? offdiag[i-1] * offdiag[i-1] : 0.;
+     q = diag[i] - x - e_sq / q;
+     if (q == 0.)
+     {
+       q = -DBL_EPSILON * (fabs (diag[i]) + fabs (x) + DBL_MIN);
+     }
+     if (q < 0.)
+     {
+       count++;
+     }
+   }
+   return (count);
+}
+
+// The k lowest eigenvalues by bisection and their eigenvectors by
+//  inverse iteration
+int tridiag_lowest (int n, const double diag[], const double offdiag[],
+                    int k, double tolerance, double eigenvalues[],
+                    double vectors[])
+{
+   double lo, hi;
+   gerschgorin (n, diag, offdiag, &lo, &hi);
+   vector<double> lower (k, lo);        // sturm_count (lower[s]) <= s
+   vector<double> upper (k, hi);        // sturm_count (upper[s]) > s
+
+   int num_counts = 0;
+   for (int s=0; s<k; s++)
+   {
+     while (upper[s] - lower[s] > tolerance)
+     {
+       double mid = 0.5 * (lower[s] + upper[s]);
+       if (mid <= lower[s] || mid >= upper[s])
+       {
+         break;                         // as close as round-off allows
+       }
+       int count = sturm_count (n, diag, offdiag, mid);
+       num_counts++;
+       for (int t=s; t<k; t++)          // every bracket it tells about
+       {
+         if (count > t)
+         {
+           upper[t] = min (upper[t], mid);
+         }
+         else
+         {
+           lower[t] = max (lower[t], mid);
+         }
+       }
+     }
+     eigenvalues[s] = 0.5 * (lower[s] + upper[s]);
+   }
+
+   for (int s=0; s<k; s++)
+   {
+     inverse_iteration (n, diag, offdiag, eigenvalues[s], s, vectors,
+                        vectors + (long) s*n);
+   }
+   return (num_counts);
+}
+
+// Normalized eigenvector for the eigenvalue E
+void tridiag_eigenvector (int n, const double diag[], const double offdiag[],
+                          double E, double x[])
+{
+   inverse_iteration (n, diag, offdiag, E, 0, NULL, x);
+}
+
+//************************************************************************
+
+// Bounds on all the eigenvalues (a little outside the Gerschgorin discs,
+//  so that no eigenvalue is at either end)
+static void gerschgorin (int n, const double diag[], const double offdiag[],
+                         double *lower_ptr, double *upper_ptr)
+{
+   double lo = diag[0];
+   double hi = diag[0];
+   for (int i=0; i<n; i++)
+   {
+     double radius = ((i > 0) ? fabs (offdiag[i-1]) : 0.)
+                     + ((i < n-1) ? fabs (offdiag[i]) : 0.);
+     lo = min (lo, diag[i] - radius);
+     hi = max (hi, diag[i] + radius);
+   }
+   double pad = 2. * DBL_EPSILON * max (fabs (lo), fabs (hi)) + DBL_MIN;
+   *lower_ptr = lo - pad;
+   *upper_ptr = hi + pad;
+}
+
+// Gaussian elimination with partial pivoting of T - E; a zero pivot is
+//  replaced by a tiny one (E is an eigenvalue, after all)
+static void factor (int n, const double diag[], const double offdiag[],
+                    double E, tridiag_lu &lu)
+{
+   lu.d.resize (n);
+   lu.du.assign (offdiag, offdiag + n-1);
+   lu.dl.assign (offdiag, offdiag + n-1);
+   lu.du2.assign (n, 0.);
+   lu.swapped.assign (n, 0);
+   lu.norm = 0.;
+   for (int i=0; i<n; i++)
+   {
+     lu.d[i] = diag[i] - E;
+     lu.norm = max (lu.norm, fabs (lu.d[i])
+                             + ((i > 0) ? fabs (offdiag[i-1]) : 0.)
+                             + ((i < n-1) ? fabs (offdiag[i]) : 0.));
+   }
+   double tiny_pivot = DBL_EPSILON * lu.norm + DBL_MIN;
+
+   for (int i=0; i<n-1; i++)
+   {
+     if (fabs (lu.d[i]) >= fabs (lu.dl[i]))
+     {
+       if (lu.d[i] == 0.)
+       {
+         lu.d[i] = tiny_pivot;
+       }
+       double fact = lu.dl[i] / lu.d[i];
+       lu.dl[i] = fact;
+       lu.d[i+1] -= fact * lu.du[i];
+     }
+     else                               // swap rows i and i+1
+     {
+       double fact = lu.d[i] / lu.dl[i];
+       lu.d[i] = lu.dl[i];
+       lu.dl[i] = fact;
+       double temp = lu.du[i];
+       lu.du[i] = lu.d[i+1];
+       lu.d[i+1] = temp - fact * lu.d[i+1];
+       if (i < n-2)
+       {
+         lu.du2[i] = lu.du[i+1];
+         lu.du[i+1] = -fact * lu.du[i+1];
+       }
+       lu.swapped[i] = 1;
+     }
+   }
+   if (lu.d[n-1] == 0.)
+   {
+     lu.d[n-1] = tiny_pivot;
+   }
+}
+
+// x <- (T - E)^-1 x with the factors from factor
+static void solve (int n, const tridiag_lu &lu, double x[])
+{
+   for (int i=0; i<n-1; i++)            // L (and the row swaps)
+   {
+     if (lu.swapped[i])
+     {
+       double temp = x[i];
+       x[i] = x[i+1];
+       x[i+1] = temp - lu.dl[i] * x[i];
+     }
+     else
+     {
+       x[i+1] -= lu.dl[i] * x[i];
+     }
+   }
+   x[n-1] /= lu.d[n-1];                 // U
+   if (n > 1)
+   {
+     x[n-2] = (x[n-2] - lu.du[n-2] * x[n-1]) / lu.d[n-2];
+   }
+   for (int i=n-3; i>=0; i--)
+   {
+     x[i] = (x[i] - lu.du[i] * x[i+1] - lu.du2[i] * x[i+2]) / lu.d[i];
+   }
+}
+
+// Eigenvector x for E, orthogonal to the num_prev vectors in prev
+static void inverse_iteration (int n, const double diag[],
+                               const double offdiag[], double E,
+                               int num_prev, const double prev[],
+                               double x[])
+{
+   tridiag_lu lu;
+   factor (n, diag, offdiag, E, lu);
+
+   // a starting vector with some of every eigenvector in it
+   unsigned long seed = 12345;
+   for (int i=0; i<n; i++)
+   {
+     seed = (1103515245UL * seed + 12345UL) % 2147483648UL;
+     x[i] = 0.5 + seed / 2147483648.;
+   }
+
+   // the residual |(T - E) x| of the normalized x is 1/|growth|
+   double residual_limit = sqrt ((double) n) * DBL_EPSILON * lu.norm;
+   bool converged = false;
+   for (int iter=0; iter<max_inverse_iter; iter++)
+   {
+     double start_norm = 0.;
+     for (int i=0; i<n; i++)
+     {
+       start_norm += x[i] * x[i];
+     }
+     start_norm = sqrt (start_norm);
+     solve (n, lu, x);
+     for (int p=0; p<num_prev; p++)
+     {
+       const double *v = prev + (long) p*n;
+       double overlap = 0.;
+       for (int i=0; i<n; i++)
+       {
+         overlap += v[i] * x[i];
+       }
+       for (int i=0; i<n; i++)
+       {
+         x[i] -= overlap * v[i];
+       }
+     }
+     double norm = 0.;
+     for (int i=0; i<n; i++)
+     {
+       norm += x[i] * x[i];
+     }
+     norm = sqrt (norm);
+     for (int i=0; i<n; i++)
+     {
+       x[i] /= norm;
+     }
+     if (converged)
+     {
+       break;                           // that was the extra solve
+     }
+     converged = (start_norm / norm <= residual_limit);
+   }
+
+   // first component that isn't tiny is positive
+   double largest = 0.;
+   for (int i=0; i<n; i++)
+   {
+     largest = max (largest, fabs (x[i]));
+   }
+   for (int i=0; i<n; i++)
+   {
+     if (fabs (x[i]) > 1.e-8 * largest)
+     {
+       if (x[i] < 0.)
+       {
+         for (int j=0; j<n; j++)
+         {
+           x[j] = -x[j];
+         }
+       }
+       break;
+     }
+   }
+}
@@ -0,0 +1,44 @@
+//  file: tridiag_eigen.h
+//
+//  Header file for tridiag_eigen.cpp: the lowest eigenvalues and
+//   eigenvectors of a real symmetric tridiagonal matrix T, by Sturm
+//   sequence bisection and inverse iteration.
+//
+//  Revision History:
+//    17-Oct-2026 --- original version
+//
+//  Notes:
+//   * T has diag[0..n-1] on the diagonal and offdiag[0..n-2] next to it
+//      (T_i,i+1 = T_i+1,i = offdiag[i]).  Nothing bigger than a few
+//      n-vectors is stored, so n can be 10^6 or more.
+//   * Each eigenvalue takes about 50-100 Sturm counts and each
+//      eigenvector a few solves with T - E, all O(n) work, instead of
+//      the O(n^3) work (and n x n memory) of gsl_eigen_symmv.
+//
+//************************************************************************
+
+#ifndef TRIDIAG_EIGEN_H
+#define TRIDIAG_EIGEN_H
+
+//  begin: function prototypes
+
+                  // number of eigenvalues of T less than x
+extern int sturm_count (int n, const double diag[], const double offdiag[],
+                        double x);
+                  // the k lowest eigenvalues (ascending) in eigenvalues[],
+                  //  each to within tolerance (or round-off), and their
+                  //  normalized eigenvectors in vectors[s*n + i]
+                  //  (s = 0,...,k-1).  Returns the total number of Sturm
+                  //  counts.
+extern int tridiag_lowest (int n, const double diag[],
+                           const double offdiag[], int k, double tolerance,
+                           double eigenvalues[], double vectors[]);
+                  // normalized eigenvector x for the eigenvalue E (already
+                  //  known accurately) by inverse iteration
+extern void tridiag_eigenvector (int n, const double diag[],
+                                 const double offdiag[], double E,
+                                 double x[]);
+
+//  end: function prototypes
+
+#endif